@@ -5,6 +5,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "esp_log.h"
 #include "nvs.h"
 
@@ -26,6 +28,48 @@ static inline bool is_success(esp_err_t err)
     return err == ESP_OK;
 }
 
+/*
+ * Batch state.  While s_batch_depth > 0 the port and control savers only keep
+ * the latest values here; config_store_end_batch() writes them in one go.
+ */
+static portMUX_TYPE s_batch_lock = portMUX_INITIALIZER_UNLOCKED;
+static unsigned s_batch_depth;
+static struct ser2net_esp32_serial_port_cfg *s_batch_ports;
+static size_t s_batch_port_count;
+static bool s_batch_ports_pending;
+static uint16_t s_batch_control_port;
+static int s_batch_control_backlog;
+static bool s_batch_control_pending;
+
+static esp_err_t put_ports(nvs_handle_t handle,
+                           const struct ser2net_esp32_serial_port_cfg *ports,
+                           size_t count)
+{
+    esp_err_t err = nvs_set_u8(handle, KEY_PORTS_VERSION, PORTS_STORE_VERSION);
+    if (err == ESP_OK)
+        err = nvs_set_u32(handle, KEY_PORTS_COUNT, (uint32_t) count);
+
+    if (err == ESP_OK) {
+        if (count > 0) {
+            err = nvs_set_blob(handle, KEY_PORTS_BLOB,
+                               ports, count * sizeof(struct ser2net_esp32_serial_port_cfg));
+        } else {
+            esp_err_t erase_err = nvs_erase_key(handle, KEY_PORTS_BLOB);
+            if (erase_err != ESP_OK && erase_err != ESP_ERR_NVS_NOT_FOUND)
+                err = erase_err;
+        }
+    }
+    return err;
+}
+
+static esp_err_t put_control(nvs_handle_t handle, uint16_t tcp_port, int backlog)
+{
+    esp_err_t err = nvs_set_u16(handle, KEY_CONTROL_PORT, tcp_port);
+    if (err == ESP_OK)
+        err = nvs_set_i32(handle, KEY_CONTROL_BACKLOG, backlog);
+    return err;
+}
+
 bool config_store_load_ports(struct ser2net_esp32_serial_port_cfg *ports,
                              size_t max_ports,
                              size_t *out_count)
@@ -100,26 +144,38 @@ bool config_store_load_ports(struct ser2net_esp32_serial_port_cfg *ports,
 bool config_store_save_ports(const struct ser2net_esp32_serial_port_cfg *ports,
                              size_t count)
 {
+    taskENTER_CRITICAL(&s_batch_lock);
+    bool batching = s_batch_depth > 0;
+    taskEXIT_CRITICAL(&s_batch_lock);
+
+    /* Only a deferred save needs its own copy.  A batch opened after the
+     * check above just gets one extra direct write. */
+    size_t bytes = count * sizeof(*ports);
+    struct ser2net_esp32_serial_port_cfg *copy = batching && bytes ? malloc(bytes) : NULL;
+    if (copy)
+        memcpy(copy, ports, bytes);
+
+    bool deferred = false;
+    struct ser2net_esp32_serial_port_cfg *stale = copy;
+    taskENTER_CRITICAL(&s_batch_lock);
+    if (batching && s_batch_depth > 0 && (copy || !bytes)) {
+        stale = s_batch_ports;
+        s_batch_ports = copy;
+        s_batch_port_count = count;
+        s_batch_ports_pending = true;
+        deferred = true;
+    }
+    taskEXIT_CRITICAL(&s_batch_lock);
+    free(stale);
+    if (deferred)
+        return true;
+
     nvs_handle_t handle;
     esp_err_t err = nvs_open(STORE_NAMESPACE, NVS_READWRITE, &handle);
     if (err != ESP_OK)
         return false;
 
-    err = nvs_set_u8(handle, KEY_PORTS_VERSION, PORTS_STORE_VERSION);
-    if (err == ESP_OK)
-        err = nvs_set_u32(handle, KEY_PORTS_COUNT, (uint32_t) count);
-
-    if (err == ESP_OK) {
-        if (count > 0) {
-            err = nvs_set_blob(handle, KEY_PORTS_BLOB,
-                               ports, count * sizeof(struct ser2net_esp32_serial_port_cfg));
-        } else {
-            esp_err_t erase_err = nvs_erase_key(handle, KEY_PORTS_BLOB);
-            if (erase_err != ESP_OK && erase_err != ESP_ERR_NVS_NOT_FOUND)
-                err = erase_err;
-        }
-    }
-
+    err = put_ports(handle, ports, count);
     if (err == ESP_OK)
         err = nvs_commit(handle);
 
@@ -162,14 +218,24 @@ bool config_store_load_control(uint16_t *tcp_port, int *backlog)
 
 bool config_store_save_control(uint16_t tcp_port, int backlog)
 {
+    bool deferred = false;
+    taskENTER_CRITICAL(&s_batch_lock);
+    if (s_batch_depth > 0) {
+        s_batch_control_port = tcp_port;
+        s_batch_control_backlog = backlog;
+        s_batch_control_pending = true;
+        deferred = true;
+    }
+    taskEXIT_CRITICAL(&s_batch_lock);
+    if (deferred)
+        return true;
+
     nvs_handle_t handle;
     esp_err_t err = nvs_open(STORE_NAMESPACE, NVS_READWRITE, &handle);
     if (err != ESP_OK)
         return false;
 
-    err = nvs_set_u16(handle, KEY_CONTROL_PORT, tcp_port);
-    if (err == ESP_OK)
-        err = nvs_set_i32(handle, KEY_CONTROL_BACKLOG, backlog);
+    err = put_control(handle, tcp_port, backlog);
     if (err == ESP_OK)
         err = nvs_commit(handle);
 
@@ -182,6 +248,59 @@ bool config_store_save_control(uint16_t tcp_port, int backlog)
     return true;
 }
 
+void config_store_begin_batch(void)
+{
+    taskENTER_CRITICAL(&s_batch_lock);
+    s_batch_depth++;
+    taskEXIT_CRITICAL(&s_batch_lock);
+}
+
+bool config_store_end_batch(void)
+{
+    struct ser2net_esp32_serial_port_cfg *ports = NULL;
+    size_t port_count = 0;
+    bool ports_pending = false;
+    uint16_t control_port = 0;
+    int control_backlog = 0;
+    bool control_pending = false;
+
+    taskENTER_CRITICAL(&s_batch_lock);
+    if (s_batch_depth > 0 && --s_batch_depth == 0) {
+        ports = s_batch_ports;
+        port_count = s_batch_port_count;
+        ports_pending = s_batch_ports_pending;
+        control_port = s_batch_control_port;
+        control_backlog = s_batch_control_backlog;
+        control_pending = s_batch_control_pending;
+        s_batch_ports = NULL;
+        s_batch_ports_pending = false;
+        s_batch_control_pending = false;
+    }
+    taskEXIT_CRITICAL(&s_batch_lock);
+
+    if (!ports_pending && !control_pending)
+        return true;
+
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(STORE_NAMESPACE, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        if (ports_pending)
+            err = put_ports(handle, ports, port_count);
+        if (err == ESP_OK && control_pending)
+            err = put_control(handle, control_port, control_backlog);
+        if (err == ESP_OK)
+            err = nvs_commit(handle);
+        nvs_close(handle);
+    }
+    free(ports);
+
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to persist batched config: %s", esp_err_to_name(err));
+        return false;
+    }
+    return true;
+}
+
 void config_store_clear_ports(void)
 {
     nvs_handle_t handle;
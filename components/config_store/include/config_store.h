@@ -21,6 +21,19 @@ bool config_store_save_ports(const struct ser2net_esp32_serial_port_cfg *ports,
 bool config_store_load_control(uint16_t *tcp_port, int *backlog);
 bool config_store_save_control(uint16_t tcp_port, int backlog);
 
+/**
+ * @brief Defer port/control saves until config_store_end_batch().
+ *
+ * While a batch is open, config_store_save_ports() and
+ * config_store_save_control() only remember the latest values.  Batches nest;
+ * the outermost config_store_end_batch() writes what was saved with a single
+ * NVS commit and returns false if that write fails.  An inner end writes
+ * nothing and returns true, so callers that report persistence must not
+ * overlap their batches.
+ */
+void config_store_begin_batch(void);
+bool config_store_end_batch(void);
+
 void config_store_clear_ports(void);
 
 bool config_store_load_wifi_credentials(char *ssid,
@@ -2,6 +2,7 @@
 #define WEB_SERVER_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -20,6 +21,22 @@ bool web_server_start(void);
  */
 void web_server_stop(void);
 
+/**
+ * @brief Tell the web server where the control port listens.
+ *
+ * The `/ws/monitor` endpoint attaches to the control port's `monitor`
+ * command over loopback. Pass 0 when the control port is disabled.
+ */
+void web_server_set_control_port(uint16_t tcp_port);
+
+/**
+ * @brief Record that the runtime port configuration changed.
+ *
+ * Invalidates the `ETag` of `GET /api/ports`.  Call it from the runtime's
+ * `config_changed_cb`; session changes are picked up without it.
+ */
+void web_server_notify_config_changed(void);
+
 #ifdef __cplusplus
 }
 #endif
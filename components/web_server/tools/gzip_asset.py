@@ -0,0 +1,28 @@
+#!/usr/bin/env python3
+"""Gzip a web UI asset for embedding into the firmware.
+
+The header carries no file name and a zero timestamp, so identical input
+always yields identical output and the ETag derived from it on the device
+only changes when the asset itself does.
+"""
+
+import gzip
+import sys
+
+
+def main() -> int:
+    if len(sys.argv) != 3:
+        print(f"usage: {sys.argv[0]} <input> <output.gz>", file=sys.stderr)
+        return 2
+    src, dst = sys.argv[1], sys.argv[2]
+    with open(src, "rb") as handle:
+        data = handle.read()
+    with open(dst, "wb") as raw:
+        with gzip.GzipFile(filename="", mode="wb", compresslevel=9,
+                           fileobj=raw, mtime=0) as out:
+            out.write(data)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
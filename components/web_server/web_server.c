@@ -1,19 +1,27 @@
 #include "web_server.h"
 
+#include <errno.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <strings.h>
+#include <inttypes.h>
 #include <limits.h>
 
 #include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
 
 #include <cJSON.h>
 #include <driver/uart.h>
 #include "esp_log.h"
 #include <esp_http_server.h>
 #include "esp_system.h"
+#include "esp_random.h"
 #include "esp_timer.h"
+#include "lwip/sockets.h"
 
 #include "ser2net_opts.h"
 #include "runtime.h"
@@ -21,335 +29,125 @@
 #include "control_port.h"
 #include "adapters.h"
 #include "net_manager.h"
+#include "config_store.h"
 
 static const char *TAG = "web_server";
 static httpd_handle_t s_server = NULL;
 
 #define MAX_REQUEST_BODY 1024
+#define BATCH_MAX_BODY 4096
+#define BATCH_MAX_OPS 16
+#define CHUNK_BUFFER_SIZE 512
+
+/* httpd sessions kept free for the page, assets and REST calls on top of the
+ * long-lived event streams and WebSockets counted in web_server_start(). */
+#define HTTP_REQUEST_SOCKETS 3
+/* lwIP sockets httpd uses itself (listener and control socket pair). */
+#define HTTPD_INTERNAL_SOCKETS 3
+
+#define ASYNC_WORKERS 2
+#define ASYNC_QUEUE_LEN 4
+#define ASYNC_WORKER_STACK 6144
+
+#define EVENTS_MAX_CLIENTS 3
+#define EVENTS_TASK_STACK 4096
+#define EVENTS_POLL_MS 250
+#define EVENTS_MIN_INTERVAL_MS 1000
+#define EVENTS_SYSTEM_INTERVAL_MS 5000
+#define EVENTS_KEEPALIVE_MS 15000
+#define EVENTS_SLOW_SEND_MS 1000
+#define EVENTS_STALL_MS 30000
+
+#define WS_BRIDGE_ENABLED CONFIG_HTTPD_WS_SUPPORT
+#define BRIDGE_MAX_CLIENTS 2
+#define BRIDGE_FRAME_MAX 512
+#define BRIDGE_TASK_STACK 4096
+#define BRIDGE_POLL_MS 50
+#define BRIDGE_STATS_MS 1000
+#define BRIDGE_TX_BUFFER 2048
+#define BRIDGE_ADMIT_TIMEOUT_MS 3000
+
+#define WS_MONITOR_ENABLED (CONFIG_HTTPD_WS_SUPPORT && ENABLE_MONITORING)
+#define MONITOR_MAX_SUBSCRIBERS 2
+#define MONITOR_RING_SIZE 2048
+#define MONITOR_FRAME_MAX 512
+#define MONITOR_TASK_STACK 4096
+#define MONITOR_POLL_MS 100
+#define MONITOR_GREETING_IDLE_MS 200
+
+/* Gzipped UI assets produced from www/ by the component CMakeLists. */
+extern const uint8_t _binary_index_html_gz_start[];
+extern const uint8_t _binary_index_html_gz_end[];
+extern const uint8_t _binary_app_css_gz_start[];
+extern const uint8_t _binary_app_css_gz_end[];
+extern const uint8_t _binary_app_js_gz_start[];
+extern const uint8_t _binary_app_js_gz_end[];
+
+#define FNV1A32_INIT 2166136261u
+
+static uint32_t fnv1a32(uint32_t hash, const void *data, size_t len)
+{
+    const uint8_t *p = data;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= p[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+struct web_asset {
+    const char *type;
+    const uint8_t *start;
+    const uint8_t *end;
+    char etag[11];
+};
+
+static struct web_asset s_web_index = {
+    "text/html; charset=utf-8", _binary_index_html_gz_start, _binary_index_html_gz_end, ""
+};
+static struct web_asset s_web_style = {
+    "text/css", _binary_app_css_gz_start, _binary_app_css_gz_end, ""
+};
+static struct web_asset s_web_script = {
+    "application/javascript", _binary_app_js_gz_start, _binary_app_js_gz_end, ""
+};
+
+static void web_asset_init_etag(struct web_asset *asset)
+{
+    uint32_t hash = fnv1a32(FNV1A32_INIT, asset->start, asset->end - asset->start);
+    snprintf(asset->etag, sizeof(asset->etag), "\"%08" PRIx32 "\"", hash);
+}
+
+static bool etag_matches(httpd_req_t *req, const char *etag)
+{
+    char header[64];
+    size_t len = httpd_req_get_hdr_value_len(req, "If-None-Match");
+    if (len == 0 || len >= sizeof(header))
+        return false;
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", header, sizeof(header)) != ESP_OK)
+        return false;
+    return strcmp(header, "*") == 0 || strstr(header, etag) != NULL;
+}
+
+static esp_err_t web_asset_handler(httpd_req_t *req)
+{
+    const struct web_asset *asset = req->user_ctx;
+
+    /* no-cache still lets the browser keep the copy; it just revalidates,
+     * which costs a 304 instead of the full asset. */
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    httpd_resp_set_hdr(req, "ETag", asset->etag);
+    httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+    if (etag_matches(req, asset->etag)) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
+    }
 
-static const char WEB_INDEX_HTML[] =
-"<!DOCTYPE html>\n"
-"<html lang=\"en\">\n"
-"<head>\n"
-"  <meta charset=\"utf-8\" />\n"
-"  <meta name=\"viewport\" content=\"width=device-width, initial-scale=1\" />\n"
-"  <title>ser2net MCU – Wi-Fi Setup</title>\n"
-"  <link rel=\"stylesheet\" href=\"/static/app.css\" />\n"
-"  <script src=\"/static/app.js\" defer></script>\n"
-"</head>\n"
-"<body>\n"
-"  <header class=\"topbar\">\n"
-"    <div class=\"brand\">ser2net MCU</div>\n"
-"    <div class=\"subtitle\">Embedded RFC2217 Gateway</div>\n"
-"  </header>\n"
-"  <main class=\"content\">\n"
-"    <section class=\"card\" id=\"wifi-status-card\">\n"
-"      <h2>Wi-Fi Status</h2>\n"
-"      <div class=\"status-grid\">\n"
-"        <div>\n"
-"          <span class=\"label\">Station SSID</span>\n"
-"          <span class=\"value\" id=\"sta-ssid\">–</span>\n"
-"        </div>\n"
-"        <div>\n"
-"          <span class=\"label\">Station IP</span>\n"
-"          <span class=\"value\" id=\"sta-ip\">–</span>\n"
-"        </div>\n"
-"        <div>\n"
-"          <span class=\"label\">Station State</span>\n"
-"          <span class=\"value\" id=\"sta-state\">–</span>\n"
-"        </div>\n"
-"        <div>\n"
-"          <span class=\"label\">Provisioning SoftAP</span>\n"
-"          <span class=\"value\" id=\"ap-state\">–</span>\n"
-"        </div>\n"
-"        <div>\n"
-"          <span class=\"label\">SoftAP Timeout</span>\n"
-"          <span class=\"value\" id=\"ap-timeout\">–</span>\n"
-"        </div>\n"
-"      </div>\n"
-"      <div class=\"actions\">\n"
-"        <button id=\"toggle-ap\" class=\"button secondary\">Toggle SoftAP</button>\n"
-"        <button id=\"forget-wifi\" class=\"button danger\">Forget Credentials</button>\n"
-"      </div>\n"
-"    </section>\n"
-"    <section class=\"card\">\n"
-"      <h2>Configure Station Wi-Fi</h2>\n"
-"      <form id=\"wifi-form\" autocomplete=\"off\">\n"
-"        <div class=\"form-row\">\n"
-"          <label for=\"ssid\">SSID</label>\n"
-"          <input type=\"text\" id=\"ssid\" name=\"ssid\" maxlength=\"32\" required placeholder=\"Network name\" />\n"
-"        </div>\n"
-"        <div class=\"form-row\">\n"
-"          <label for=\"password\">Password</label>\n"
-"          <input type=\"password\" id=\"password\" name=\"password\" maxlength=\"64\" placeholder=\"leave empty for open network\" />\n"
-"        </div>\n"
-"        <div class=\"form-row inline\">\n"
-"          <label for=\"keep-ap\">\n"
-"            <input type=\"checkbox\" id=\"keep-ap\" name=\"keep_ap\" checked />\n"
-"            Keep provisioning SoftAP enabled after applying credentials\n"
-"          </label>\n"
-"        </div>\n"
-"        <div class=\"form-row\">\n"
-"          <button type=\"submit\" class=\"button primary\">Save &amp; Connect</button>\n"
-"        </div>\n"
-"      </form>\n"
-"      <div id=\"message\" class=\"message\" hidden></div>\n"
-"    </section>\n"
-"    <section class=\"card\" id=\"ports-card\">\n"
-"      <h2>Serial Ports</h2>\n"
-"      <div class=\"table-wrapper\">\n"
-"        <table class=\"status-table\">\n"
-"          <thead>\n"
-"            <tr>\n"
-"              <th>TCP Port</th>\n"
-"              <th>UART</th>\n"
-"              <th>Mode</th>\n"
-"              <th>Enabled</th>\n"
-"              <th>Baud</th>\n"
-"              <th>Frame</th>\n"
-"              <th>Flow</th>\n"
-"              <th>Sessions</th>\n"
-"            </tr>\n"
-"          </thead>\n"
-"          <tbody id=\"ports-table-body\">\n"
-"            <tr><td colspan=\"8\">Loading…</td></tr>\n"
-"          </tbody>\n"
-"        </table>\n"
-"      </div>\n"
-"    </section>\n"
-"  </main>\n"
-"</body>\n"
-"</html>\n";
-
-static const char WEB_STYLE_CSS[] =
-"@import url('https://fonts.googleapis.com/css2?family=Inter:wght@400;600&display=swap');\n"
-"*{box-sizing:border-box;margin:0;padding:0;font-family:'Inter',sans-serif;color:#1c1c1c;}\n"
-"body{background:#f2f4f8;}\n"
-".topbar{background:linear-gradient(135deg,#0f5fb6,#0b3d82);color:#fff;padding:1.5rem 2rem;display:flex;flex-direction:column;gap:.3rem;box-shadow:0 4px 12px rgba(0,0,0,.2);}\n"
-".brand{font-size:1.6rem;font-weight:600;letter-spacing:.04em;text-transform:uppercase;}\n"
-".subtitle{opacity:.85;font-size:.9rem;}\n"
-".content{display:grid;gap:1.5rem;padding:2rem;max-width:960px;margin:0 auto;}\n"
-".card{background:#fff;border-radius:16px;padding:2rem;box-shadow:0 12px 30px rgba(15,50,90,.12);border:1px solid rgba(12,53,109,.06);}\n"
-".card h2{margin-bottom:1.2rem;color:#0b3d82;font-size:1.25rem;font-weight:600;}\n"
-".status-grid{display:grid;grid-template-columns:repeat(auto-fit,minmax(180px,1fr));gap:1rem;margin-bottom:1.5rem;}\n"
-".label{display:block;font-size:.75rem;text-transform:uppercase;letter-spacing:.08em;color:#6b778c;margin-bottom:.35rem;}\n"
-".value{font-size:1rem;font-weight:600;color:#172b4d;}\n"
-".actions{display:flex;gap:.75rem;flex-wrap:wrap;}\n"
-".button{border:none;padding:.6rem 1.3rem;border-radius:999px;font-size:.95rem;font-weight:600;cursor:pointer;transition:transform .15s ease,box-shadow .15s ease;}\n"
-".button:hover{transform:translateY(-1px);box-shadow:0 8px 18px rgba(10,30,60,.18);}\n"
-".button.primary{background:#0f5fb6;color:#fff;}\n"
-".button.secondary{background:#e1ebf8;color:#10396f;}\n"
-".button.danger{background:#ff6f61;color:#fff;}\n"
-".form-row{display:flex;flex-direction:column;margin-bottom:1.2rem;}\n"
-".form-row.inline{flex-direction:row;align-items:center;gap:.75rem;}\n"
-"label{font-size:.85rem;font-weight:600;color:#344563;margin-bottom:.45rem;}\n"
-"input[type=text],input[type=password]{border:1px solid rgba(15,63,118,.18);border-radius:10px;padding:.65rem .9rem;font-size:1rem;background:#f9fbff;transition:border-color .2s ease,box-shadow .2s ease;}\n"
-"input[type=text]:focus,input[type=password]:focus{outline:none;border-color:#0f5fb6;box-shadow:0 0 0 3px rgba(15,95,182,.18);}\n"
-".message{margin-top:1rem;padding:.85rem 1rem;border-radius:12px;font-size:.95rem;font-weight:500;background:#e8f4ff;color:#0b3d82;border:1px solid rgba(15,95,182,.25);}\n"
-".message.error{background:#ffeceb;color:#7d1b1b;border-color:rgba(200,40,40,.35);}\n"
-".message.success{background:#ecfff0;color:#17613b;border-color:rgba(34,139,76,.35);}\n"
-".table-wrapper{overflow-x:auto;}\n"
-".status-table{width:100%;border-collapse:collapse;font-size:.92rem;}\n"
-".status-table th,.status-table td{padding:.6rem .75rem;text-align:left;border-bottom:1px solid rgba(15,63,118,.12);}\n"
-".status-table th{font-size:.75rem;text-transform:uppercase;letter-spacing:.08em;color:#5c6c80;background:#f5f8ff;}\n"
-".status-table tbody tr:hover{background:#f2f7ff;}\n"
-"@media(max-width:640px){.card{padding:1.5rem;} .topbar{padding:1.2rem 1.5rem;}}\n";
-
-static const char WEB_APP_JS[] =
-"const statusElements={ssid:document.getElementById('sta-ssid'),ip:document.getElementById('sta-ip'),state:document.getElementById('sta-state'),ap:document.getElementById('ap-state'),apTimeout:document.getElementById('ap-timeout')};\n"
-"const messageBox=document.getElementById('message');\n"
-"const form=document.getElementById('wifi-form');\n"
-"const toggleApBtn=document.getElementById('toggle-ap');\n"
-"const forgetBtn=document.getElementById('forget-wifi');\n"
-"const portsTableBody=document.getElementById('ports-table-body');\n"
-"\n"
-"function showMessage(text,type='info'){\n"
-"  messageBox.textContent=text;\n"
-"  messageBox.classList.remove('error','success');\n"
-"  if(type==='error') messageBox.classList.add('error');\n"
-"  if(type==='success') messageBox.classList.add('success');\n"
-"  messageBox.hidden=false;\n"
-"}\n"
-"\n"
-"function hideMessage(){messageBox.hidden=true;}\n"
-"\n"
-"function describeState(connected,configured){\n"
-"  if(!configured) return 'Not configured';\n"
-"  return connected?'Connected':'Disconnected';\n"
-"}\n"
-"\n"
-"function describeAp(active,forcedDisable,remaining){\n"
-"  if(forcedDisable) return 'Disabled (forced)';\n"
-"  if(!active) return 'Standby';\n"
-"  if(remaining>0) return `Active (${remaining}s left)`;\n"
-"  return 'Active';\n"
-"}\n"
-"\n"
-"async function fetchWifiStatus(){\n"
-"  const res=await fetch('/api/wifi',{cache:'no-store'});\n"
-"  if(!res.ok) throw new Error('Unable to retrieve Wi-Fi status');\n"
-"  return res.json();\n"
-"}\n"
-"\n"
-"async function fetchSystem(){\n"
-"  const res=await fetch('/api/system',{cache:'no-store'});\n"
-"  if(!res.ok) throw new Error('Unable to retrieve system status');\n"
-"  return res.json();\n"
-"}\n"
-"\n"
-"async function fetchPorts(){\n"
-"  const res=await fetch('/api/ports',{cache:'no-store'});\n"
-"  if(!res.ok) throw new Error('Unable to retrieve port list');\n"
-"  return res.json();\n"
-"}\n"
-"\n"
-"function formatFrame(port){\n"
-"  return `${port.data_bits}/${port.parity}/${port.stop_bits}`;\n"
-"}\n"
-"\n"
-"function renderPorts(ports){\n"
-"  if(!Array.isArray(ports)){return;}\n"
-"  portsTableBody.innerHTML='';\n"
-"  if(ports.length===0){\n"
-"    const row=document.createElement('tr');\n"
-"    const cell=document.createElement('td');\n"
-"    cell.colSpan=8;\n"
-"    cell.textContent='No serial ports configured';\n"
-"    row.appendChild(cell);\n"
-"    portsTableBody.appendChild(row);\n"
-"    return;\n"
-"  }\n"
-"  ports.forEach(port=>{\n"
-"    const row=document.createElement('tr');\n"
-"    const cells=[\n"
-"      port.tcp_port,\n"
-"      `UART${port.uart}`,\n"
-"      port.mode,\n"
-"      port.enabled?'Yes':'No',\n"
-"      port.baud,\n"
-"      formatFrame(port),\n"
-"      port.flow_control===0?'None':'RTS/CTS',\n"
-"      port.active_sessions\n"
-"    ];\n"
-"    cells.forEach(value=>{\n"
-"      const cell=document.createElement('td');\n"
-"      cell.textContent=value;\n"
-"      row.appendChild(cell);\n"
-"    });\n"
-"    portsTableBody.appendChild(row);\n"
-"  });\n"
-"}\n"
-"\n"
-"async function refreshStatus(){\n"
-"  try{\n"
-"    const [wifi,sys,ports]=await Promise.allSettled([fetchWifiStatus(),fetchSystem(),fetchPorts()]);\n"
-"    if(wifi.status==='fulfilled'){\n"
-"      const data=wifi.value;\n"
-"      statusElements.ssid.textContent=data.sta_ssid||'–';\n"
-"      statusElements.ip.textContent=data.sta_ip||'–';\n"
-"      statusElements.state.textContent=describeState(data.sta_connected,data.sta_configured);\n"
-"      statusElements.ap.textContent=describeAp(data.softap_active,data.softap_force_disabled,data.softap_remaining_seconds);\n"
-"      statusElements.apTimeout.textContent=data.softap_remaining_seconds?`${data.softap_remaining_seconds}s`:'–';\n"
-"      toggleApBtn.textContent=data.softap_force_disabled?'Enable SoftAP':'Disable SoftAP';\n"
-"    }\n"
-"    if(sys.status==='fulfilled'){\n"
-"      const uptime=document.getElementById('sta-state');\n"
-"      const seconds=Math.floor(sys.value.uptime_ms/1000);\n"
-"      uptime.dataset.uptime=`Uptime: ${seconds}s`;\n"
-"    }\n"
-"    if(ports.status==='fulfilled'){\n"
-"      renderPorts(ports.value);\n"
-"    }\n"
-"  }catch(err){\n"
-"    console.error(err);\n"
-"    showMessage(err.message,'error');\n"
-"  }\n"
-"}\n"
-"\n"
-"form.addEventListener('submit',async(e)=>{\n"
-"  e.preventDefault();\n"
-"  hideMessage();\n"
-"  const ssid=document.getElementById('ssid').value.trim();\n"
-"  const password=document.getElementById('password').value;\n"
-"  const keepAp=document.getElementById('keep-ap').checked;\n"
-"  if(!ssid){\n"
-"    showMessage('SSID must not be empty','error');\n"
-"    return;\n"
-"  }\n"
-"  try{\n"
-"    const payload={ssid,password,softap_enabled:keepAp};\n"
-"    const res=await fetch('/api/wifi',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify(payload)});\n"
-"    if(!res.ok){\n"
-"      const text=await res.text();\n"
-"      throw new Error(text||'Failed to apply credentials');\n"
-"    }\n"
-"    showMessage('Credentials saved. Connecting…','success');\n"
-"    form.reset();\n"
-"    document.getElementById('keep-ap').checked=keepAp;\n"
-"    await refreshStatus();\n"
-"  }catch(err){\n"
-"    console.error(err);\n"
-"    showMessage(err.message,'error');\n"
-"  }\n"
-"});\n"
-"\n"
-"toggleApBtn.addEventListener('click',async()=>{\n"
-"  hideMessage();\n"
-"  try{\n"
-"    const current=await fetchWifiStatus();\n"
-"    const desired=current.softap_force_disabled;\n"
-"    const res=await fetch('/api/wifi',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify({softap_enabled:desired})});\n"
-"    if(!res.ok){\n"
-"      const text=await res.text();\n"
-"      throw new Error(text||'Failed to toggle SoftAP');\n"
-"    }\n"
-"    showMessage(`SoftAP ${desired?'enabled':'disabled'}.`,'success');\n"
-"    await refreshStatus();\n"
-"  }catch(err){\n"
-"    console.error(err);\n"
-"    showMessage(err.message,'error');\n"
-"  }\n"
-"});\n"
-"\n"
-"forgetBtn.addEventListener('click',async()=>{\n"
-"  hideMessage();\n"
-"  if(!confirm('Forget stored Wi-Fi credentials and return to provisioning mode?')) return;\n"
-"  try{\n"
-"    const res=await fetch('/api/wifi',{method:'DELETE'});\n"
-"    if(!res.ok){\n"
-"      const text=await res.text();\n"
-"      throw new Error(text||'Failed to clear credentials');\n"
-"    }\n"
-"    showMessage('Credentials cleared. Device is now in provisioning mode.','success');\n"
-"    await refreshStatus();\n"
-"  }catch(err){\n"
-"    console.error(err);\n"
-"    showMessage(err.message,'error');\n"
-"  }\n"
-"});\n"
-"\n"
-"document.addEventListener('DOMContentLoaded',refreshStatus);\n"
-"window.setInterval(refreshStatus,5000);\n";
-static esp_err_t web_index_handler(httpd_req_t *req)
-{
-    httpd_resp_set_type(req, "text/html; charset=utf-8");
-    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
-    return httpd_resp_send(req, WEB_INDEX_HTML, HTTPD_RESP_USE_STRLEN);
-}
-
-static esp_err_t web_style_handler(httpd_req_t *req)
-{
-    httpd_resp_set_type(req, "text/css; charset=utf-8");
-    httpd_resp_set_hdr(req, "Cache-Control", "max-age=3600");
-    return httpd_resp_send(req, WEB_STYLE_CSS, HTTPD_RESP_USE_STRLEN);
-}
-
-static esp_err_t web_script_handler(httpd_req_t *req)
-{
-    httpd_resp_set_type(req, "application/javascript; charset=utf-8");
-    httpd_resp_set_hdr(req, "Cache-Control", "max-age=60");
-    return httpd_resp_send(req, WEB_APP_JS, HTTPD_RESP_USE_STRLEN);
+    httpd_resp_set_type(req, asset->type);
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    return httpd_resp_send(req, (const char *)asset->start, asset->end - asset->start);
 }
+
 static const char *port_mode_to_str(enum ser2net_port_mode mode)
 {
     switch (mode) {
@@ -419,6 +217,20 @@ static int sessions_for_port(uint16_t tcp_port,
     return total;
 }
 
+/* Bumped on every runtime configuration change (see
+ * web_server_notify_config_changed); seeded randomly at start so tags from a
+ * previous boot never match. */
+static uint32_t s_config_generation;
+
+static uint32_t sessions_fingerprint(const struct ser2net_active_session *sessions,
+                                     size_t count)
+{
+    uint32_t hash = FNV1A32_INIT;
+    for (size_t i = 0; i < count; ++i)
+        hash = fnv1a32(hash, &sessions[i].tcp_port, sizeof(sessions[i].tcp_port));
+    return hash;
+}
+
 static esp_err_t send_json_error(httpd_req_t *req, const char *status, const char *message)
 {
     if (status)
@@ -435,7 +247,7 @@ static esp_err_t send_json_error(httpd_req_t *req, const char *status, const cha
     return httpd_resp_send(req, buf, HTTPD_RESP_USE_STRLEN);
 }
 
-static bool read_json_body(httpd_req_t *req, cJSON **out_json)
+static bool read_json_body_limit(httpd_req_t *req, cJSON **out_json, size_t limit)
 {
     if (!out_json)
         return false;
@@ -444,7 +256,7 @@ static bool read_json_body(httpd_req_t *req, cJSON **out_json)
         send_json_error(req, "400 Bad Request", "body required");
         return false;
     }
-    if (req->content_len > MAX_REQUEST_BODY) {
+    if (req->content_len > limit) {
         send_json_error(req, "413 Payload Too Large", "request too large");
         return false;
     }
@@ -478,6 +290,11 @@ static bool read_json_body(httpd_req_t *req, cJSON **out_json)
     return true;
 }
 
+static bool read_json_body(httpd_req_t *req, cJSON **out_json)
+{
+    return read_json_body_limit(req, out_json, MAX_REQUEST_BODY);
+}
+
 static const struct ser2net_esp32_serial_port_cfg *
 find_port_by_tcp(uint16_t tcp_port,
                  const struct ser2net_esp32_serial_port_cfg *ports,
@@ -567,82 +384,304 @@ static void fill_params_from_cfg(const struct ser2net_esp32_serial_port_cfg *cfg
     params->flow_control = (cfg->flow_ctrl == UART_HW_FLOWCTRL_CTS_RTS) ? 1 : 0;
 }
 
-static cJSON *port_to_json(const struct ser2net_esp32_serial_port_cfg *cfg, int active_sessions)
+struct chunk_writer {
+    httpd_req_t *req;
+    esp_err_t err;
+    size_t len;
+    char buf[CHUNK_BUFFER_SIZE];
+};
+
+static void chunk_writer_flush(struct chunk_writer *w)
+{
+    if (w->err == ESP_OK && w->len > 0)
+        w->err = httpd_resp_send_chunk(w->req, w->buf, w->len);
+    w->len = 0;
+}
+
+static void chunk_writer_printf(struct chunk_writer *w, const char *fmt, ...)
+{
+    if (w->err != ESP_OK)
+        return;
+
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        va_list ap;
+        va_start(ap, fmt);
+        int written = vsnprintf(w->buf + w->len, sizeof(w->buf) - w->len, fmt, ap);
+        va_end(ap);
+        if (written < 0) {
+            w->err = ESP_FAIL;
+            return;
+        }
+        if ((size_t) written < sizeof(w->buf) - w->len) {
+            w->len += (size_t) written;
+            return;
+        }
+        /* Did not fit: flush what we have and retry into an empty buffer. */
+        chunk_writer_flush(w);
+    }
+    w->err = ESP_ERR_INVALID_SIZE;
+}
+
+static void chunk_writer_write(struct chunk_writer *w, const char *data, size_t len)
+{
+    while (w->err == ESP_OK && len > 0) {
+        if (w->len == sizeof(w->buf))
+            chunk_writer_flush(w);
+        size_t n = sizeof(w->buf) - w->len;
+        if (n > len)
+            n = len;
+        memcpy(w->buf + w->len, data, n);
+        w->len += n;
+        data += n;
+        len -= n;
+    }
+}
+
+static esp_err_t chunk_writer_finish(struct chunk_writer *w)
 {
-    cJSON *obj = cJSON_CreateObject();
-    if (!obj)
+    chunk_writer_flush(w);
+    if (w->err != ESP_OK)
+        return w->err;
+    return httpd_resp_send_chunk(w->req, NULL, 0);
+}
+
+#define JSON_MAX_DEPTH 4
+
+/*
+ * Minimal streaming JSON writer on top of chunk_writer.  Output goes straight
+ * into the chunk buffer, so a response costs one fixed-size buffer instead of
+ * a cJSON tree plus the printed string.
+ */
+struct json_writer {
+    struct chunk_writer out;
+    int depth;
+    bool after_key;
+    bool has_items[JSON_MAX_DEPTH];
+};
+
+/*
+ * The first flushed chunk carries the headers, so the status and content type
+ * are set here, before anything can be written.  @status may be NULL for 200.
+ */
+static struct json_writer *json_writer_new(httpd_req_t *req, const char *status)
+{
+    struct json_writer *jw = calloc(1, sizeof(*jw));
+    if (!jw)
         return NULL;
+    jw->out.req = req;
+    if (status)
+        httpd_resp_set_status(req, status);
+    httpd_resp_set_type(req, "application/json");
+    return jw;
+}
+
+static void json_separator(struct json_writer *jw)
+{
+    if (jw->after_key) {
+        jw->after_key = false;
+        return;
+    }
+    if (jw->depth > 0) {
+        if (jw->has_items[jw->depth - 1])
+            chunk_writer_printf(&jw->out, ",");
+        jw->has_items[jw->depth - 1] = true;
+    }
+}
+
+static void json_open(struct json_writer *jw, char bracket)
+{
+    json_separator(jw);
+    if (jw->depth >= JSON_MAX_DEPTH) {
+        jw->out.err = ESP_ERR_INVALID_STATE;
+        return;
+    }
+    jw->has_items[jw->depth++] = false;
+    chunk_writer_printf(&jw->out, "%c", bracket);
+}
+
+static void json_close(struct json_writer *jw, char bracket)
+{
+    if (jw->depth > 0)
+        jw->depth--;
+    chunk_writer_printf(&jw->out, "%c", bracket);
+}
+
+static void json_begin_object(struct json_writer *jw) { json_open(jw, '{'); }
+static void json_end_object(struct json_writer *jw) { json_close(jw, '}'); }
+static void json_begin_array(struct json_writer *jw) { json_open(jw, '['); }
+static void json_end_array(struct json_writer *jw) { json_close(jw, ']'); }
+
+static void json_string_value(struct json_writer *jw, const char *str)
+{
+    const char *run = str ? str : "";
+    chunk_writer_write(&jw->out, "\"", 1);
+    for (const char *c = run; *c; ++c) {
+        unsigned char ch = (unsigned char) *c;
+        if (ch != '"' && ch != '\\' && ch >= 0x20)
+            continue;
+        /* Copy the plain run before the character that needs escaping. */
+        chunk_writer_write(&jw->out, run, (size_t) (c - run));
+        if (ch < 0x20)
+            chunk_writer_printf(&jw->out, "\\u%04x", ch);
+        else
+            chunk_writer_printf(&jw->out, "\\%c", ch);
+        run = c + 1;
+    }
+    chunk_writer_write(&jw->out, run, strlen(run));
+    chunk_writer_write(&jw->out, "\"", 1);
+}
+
+static void json_key(struct json_writer *jw, const char *key)
+{
+    json_separator(jw);
+    json_string_value(jw, key);
+    chunk_writer_printf(&jw->out, ":");
+    jw->after_key = true;
+}
+
+static void json_number(struct json_writer *jw, const char *key, double value)
+{
+    json_key(jw, key);
+    json_separator(jw);
+    chunk_writer_printf(&jw->out, "%.15g", value);
+}
+
+static void json_bool(struct json_writer *jw, const char *key, bool value)
+{
+    json_key(jw, key);
+    json_separator(jw);
+    chunk_writer_printf(&jw->out, value ? "true" : "false");
+}
+
+static void json_string(struct json_writer *jw, const char *key, const char *value)
+{
+    json_key(jw, key);
+    json_separator(jw);
+    json_string_value(jw, value);
+}
+
+static esp_err_t json_writer_send(struct json_writer *jw)
+{
+    esp_err_t res = chunk_writer_finish(&jw->out);
+    free(jw);
+    return res;
+}
 
-    cJSON_AddNumberToObject(obj, "tcp_port", cfg->tcp_port);
-    cJSON_AddNumberToObject(obj, "uart", cfg->uart_num);
-    cJSON_AddNumberToObject(obj, "tx_pin", cfg->tx_pin);
-    cJSON_AddNumberToObject(obj, "rx_pin", cfg->rx_pin);
+static void port_write_json(struct json_writer *jw,
+                            const struct ser2net_esp32_serial_port_cfg *cfg,
+                            int active_sessions)
+{
+    json_begin_object(jw);
+    json_number(jw, "tcp_port", cfg->tcp_port);
+    json_number(jw, "uart", cfg->uart_num);
+    json_number(jw, "tx_pin", cfg->tx_pin);
+    json_number(jw, "rx_pin", cfg->rx_pin);
     if (cfg->rts_pin != UART_PIN_NO_CHANGE)
-        cJSON_AddNumberToObject(obj, "rts_pin", cfg->rts_pin);
+        json_number(jw, "rts_pin", cfg->rts_pin);
     if (cfg->cts_pin != UART_PIN_NO_CHANGE)
-        cJSON_AddNumberToObject(obj, "cts_pin", cfg->cts_pin);
-    cJSON_AddStringToObject(obj, "mode", port_mode_to_str(cfg->mode));
-    cJSON_AddBoolToObject(obj, "enabled", cfg->enabled);
-    cJSON_AddNumberToObject(obj, "baud", cfg->baud_rate);
-    cJSON_AddNumberToObject(obj, "data_bits", data_bits_to_int(cfg->data_bits));
-    cJSON_AddStringToObject(obj, "parity", parity_to_str(cfg->parity));
-    cJSON_AddNumberToObject(obj, "stop_bits", stop_bits_to_value(cfg->stop_bits));
-    cJSON_AddNumberToObject(obj, "flow_control", cfg->flow_ctrl);
-    cJSON_AddNumberToObject(obj, "idle_timeout_ms", cfg->idle_timeout_ms);
-    cJSON_AddNumberToObject(obj, "active_sessions", active_sessions);
-    return obj;
-}
-
-static esp_err_t send_json_response(httpd_req_t *req, cJSON *json, int status)
-{
-    char *payload = cJSON_PrintUnformatted(json);
-    if (!payload)
-        return httpd_resp_send_500(req);
+        json_number(jw, "cts_pin", cfg->cts_pin);
+    json_string(jw, "mode", port_mode_to_str(cfg->mode));
+    json_bool(jw, "enabled", cfg->enabled);
+    json_number(jw, "baud", cfg->baud_rate);
+    json_number(jw, "data_bits", data_bits_to_int(cfg->data_bits));
+    json_string(jw, "parity", parity_to_str(cfg->parity));
+    json_number(jw, "stop_bits", stop_bits_to_value(cfg->stop_bits));
+    json_number(jw, "flow_control", cfg->flow_ctrl);
+    json_number(jw, "idle_timeout_ms", cfg->idle_timeout_ms);
+    json_number(jw, "active_sessions", active_sessions);
+    json_end_object(jw);
+}
 
-    if (status == 201)
-        httpd_resp_set_status(req, "201 Created");
-    httpd_resp_set_type(req, "application/json");
-    esp_err_t res = httpd_resp_send(req, payload, HTTPD_RESP_USE_STRLEN);
-    cJSON_free(payload);
-    return res;
+/* Serialise every port with its session count, as GET /api/ports returns it. */
+static void ports_write_json(struct json_writer *jw,
+                             const struct ser2net_esp32_serial_port_cfg *ports, size_t count,
+                             const struct ser2net_active_session *sessions, size_t session_count)
+{
+    json_begin_array(jw);
+    for (size_t i = 0; i < count; ++i)
+        port_write_json(jw, &ports[i], sessions_for_port(ports[i].tcp_port, sessions, session_count));
+    json_end_array(jw);
 }
 
-static esp_err_t health_handler(httpd_req_t *req)
+static void system_write_json(struct json_writer *jw, size_t port_count, size_t session_count)
 {
-    cJSON *obj = cJSON_CreateObject();
-    if (!obj)
-        return httpd_resp_send_500(req);
-    cJSON_AddStringToObject(obj, "status", "ok");
-    esp_err_t res = send_json_response(req, obj, 200);
-    cJSON_Delete(obj);
-    return res;
+    json_begin_object(jw);
+    json_number(jw, "uptime_ms", (double)(esp_timer_get_time() / 1000ULL));
+    json_number(jw, "free_heap", (double) esp_get_free_heap_size());
+    json_number(jw, "min_free_heap", (double) esp_get_minimum_free_heap_size());
+    json_number(jw, "configured_ports", (double) port_count);
+    json_number(jw, "active_sessions", (double) session_count);
+    json_end_object(jw);
 }
 
-static esp_err_t ports_get_handler(httpd_req_t *req)
+static void wifi_write_json(struct json_writer *jw, const struct net_manager_status *status)
+{
+    json_begin_object(jw);
+    json_bool(jw, "sta_configured", status->sta_configured);
+    json_bool(jw, "sta_connected", status->sta_connected);
+    json_string(jw, "sta_ssid", status->sta_ssid);
+    json_string(jw, "sta_ip", status->sta_ip);
+    json_bool(jw, "softap_active", status->ap_active);
+    json_bool(jw, "softap_force_disabled", status->ap_force_disabled);
+    json_number(jw, "softap_remaining_seconds", status->ap_remaining_seconds);
+    json_end_object(jw);
+}
+
+#if ENABLE_DYNAMIC_SESSIONS
+/* Re-read the runtime and answer with the current state of one port. */
+static esp_err_t send_port_response(httpd_req_t *req, uint16_t tcp_port, const char *status)
 {
     struct ser2net_esp32_serial_port_cfg ports[SER2NET_MAX_PORTS];
     size_t count = ser2net_runtime_copy_ports(ports, SER2NET_MAX_PORTS);
-
     struct ser2net_active_session sessions[SER2NET_MAX_PORTS];
     size_t session_count = ser2net_runtime_list_sessions(sessions, SER2NET_MAX_PORTS);
 
-    cJSON *root = cJSON_CreateArray();
-    if (!root)
+    const struct ser2net_esp32_serial_port_cfg *cfg = find_port_by_tcp(tcp_port, ports, count);
+    if (!cfg)
         return httpd_resp_send_500(req);
 
-    for (size_t i = 0; i < count; ++i) {
-        int active = sessions_for_port(ports[i].tcp_port, sessions, session_count);
-        cJSON *item = port_to_json(&ports[i], active);
-        if (!item) {
-            cJSON_Delete(root);
-            return httpd_resp_send_500(req);
-        }
-        cJSON_AddItemToArray(root, item);
+    struct json_writer *jw = json_writer_new(req, status);
+    if (!jw)
+        return httpd_resp_send_500(req);
+    port_write_json(jw, cfg, sessions_for_port(tcp_port, sessions, session_count));
+    return json_writer_send(jw);
+}
+#endif
+
+static esp_err_t health_handler(httpd_req_t *req)
+{
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, "{\"status\":\"ok\"}", HTTPD_RESP_USE_STRLEN);
+}
+
+static esp_err_t ports_get_handler(httpd_req_t *req)
+{
+    struct ser2net_active_session sessions[SER2NET_MAX_PORTS];
+    size_t session_count = ser2net_runtime_list_sessions(sessions, SER2NET_MAX_PORTS);
+
+    /* The listing only depends on the port configuration and on how many
+     * sessions each port holds, so the tag is built from exactly that and a
+     * poller that already has the current listing gets an empty 304. */
+    char etag[24];
+    snprintf(etag, sizeof(etag), "\"%08" PRIx32 "-%08" PRIx32 "\"",
+             __atomic_load_n(&s_config_generation, __ATOMIC_RELAXED),
+             sessions_fingerprint(sessions, session_count));
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    httpd_resp_set_hdr(req, "ETag", etag);
+    if (etag_matches(req, etag)) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
     }
 
-    esp_err_t res = send_json_response(req, root, 200);
-    cJSON_Delete(root);
-    return res;
+    struct ser2net_esp32_serial_port_cfg ports[SER2NET_MAX_PORTS];
+    size_t count = ser2net_runtime_copy_ports(ports, SER2NET_MAX_PORTS);
+
+    struct json_writer *jw = json_writer_new(req, NULL);
+    if (!jw)
+        return httpd_resp_send_500(req);
+
+    ports_write_json(jw, ports, count, sessions, session_count);
+    return json_writer_send(jw);
 }
 
 static esp_err_t system_get_handler(httpd_req_t *req)
@@ -652,50 +691,105 @@ static esp_err_t system_get_handler(httpd_req_t *req)
     struct ser2net_active_session sessions[SER2NET_MAX_PORTS];
     size_t session_count = ser2net_runtime_list_sessions(sessions, SER2NET_MAX_PORTS);
 
-    cJSON *root = cJSON_CreateObject();
-    if (!root)
+    struct json_writer *jw = json_writer_new(req, NULL);
+    if (!jw)
         return httpd_resp_send_500(req);
 
-    cJSON_AddNumberToObject(root, "uptime_ms", (double)(esp_timer_get_time() / 1000ULL));
-    cJSON_AddNumberToObject(root, "free_heap", (double) esp_get_free_heap_size());
-    cJSON_AddNumberToObject(root, "min_free_heap", (double) esp_get_minimum_free_heap_size());
-    cJSON_AddNumberToObject(root, "configured_ports", (double) port_count);
-    cJSON_AddNumberToObject(root, "active_sessions", (double) session_count);
+    system_write_json(jw, port_count, session_count);
+    return json_writer_send(jw);
+}
 
-    esp_err_t res = send_json_response(req, root, 200);
-    cJSON_Delete(root);
-    return res;
+#if WS_BRIDGE_ENABLED
+/* Browser terminal totals, updated by the bridge under s_bridge_lock. */
+static uint32_t s_bridge_sessions;
+static uint32_t s_bridge_bytes_to_serial;
+static uint32_t s_bridge_bytes_from_serial;
+#endif
+
+static void metric_header(struct chunk_writer *w, const char *name,
+                          const char *type, const char *help)
+{
+    chunk_writer_printf(w, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
 }
 
-static cJSON *wifi_status_to_json(const struct net_manager_status *status)
+static esp_err_t metrics_get_handler(httpd_req_t *req)
 {
-    cJSON *root = cJSON_CreateObject();
-    if (!root)
-        return NULL;
+    struct ser2net_esp32_serial_port_cfg ports[SER2NET_MAX_PORTS];
+    size_t port_count = ser2net_runtime_copy_ports(ports, SER2NET_MAX_PORTS);
+    struct ser2net_active_session sessions[SER2NET_MAX_PORTS];
+    size_t session_count = ser2net_runtime_list_sessions(sessions, SER2NET_MAX_PORTS);
+
+    struct chunk_writer *w = calloc(1, sizeof(*w));
+    if (!w)
+        return httpd_resp_send_500(req);
+    w->req = req;
+
+    httpd_resp_set_type(req, "text/plain; version=0.0.4; charset=utf-8");
+
+    metric_header(w, "ser2net_uptime_seconds", "gauge", "Time since boot.");
+    chunk_writer_printf(w, "ser2net_uptime_seconds %.3f\n",
+                        (double) esp_timer_get_time() / 1000000.0);
+    metric_header(w, "ser2net_free_heap_bytes", "gauge", "Currently free heap.");
+    chunk_writer_printf(w, "ser2net_free_heap_bytes %u\n",
+                        (unsigned) esp_get_free_heap_size());
+    metric_header(w, "ser2net_min_free_heap_bytes", "gauge", "Lowest free heap since boot.");
+    chunk_writer_printf(w, "ser2net_min_free_heap_bytes %u\n",
+                        (unsigned) esp_get_minimum_free_heap_size());
+    metric_header(w, "ser2net_configured_ports", "gauge", "Number of configured serial ports.");
+    chunk_writer_printf(w, "ser2net_configured_ports %u\n", (unsigned) port_count);
+    metric_header(w, "ser2net_active_sessions", "gauge", "Number of connected clients.");
+    chunk_writer_printf(w, "ser2net_active_sessions %u\n", (unsigned) session_count);
+
+    metric_header(w, "ser2net_port_enabled", "gauge", "Whether the port listener is enabled.");
+    for (size_t i = 0; i < port_count; ++i) {
+        chunk_writer_printf(w, "ser2net_port_enabled{tcp_port=\"%u\",uart=\"%d\",mode=\"%s\"} %d\n",
+                            ports[i].tcp_port, (int) ports[i].uart_num,
+                            port_mode_to_str(ports[i].mode), ports[i].enabled ? 1 : 0);
+    }
+    metric_header(w, "ser2net_port_baud", "gauge", "Configured baud rate.");
+    for (size_t i = 0; i < port_count; ++i) {
+        chunk_writer_printf(w, "ser2net_port_baud{tcp_port=\"%u\"} %d\n",
+                            ports[i].tcp_port, (int) ports[i].baud_rate);
+    }
+    metric_header(w, "ser2net_port_active_sessions", "gauge", "Connected clients per port.");
+    for (size_t i = 0; i < port_count; ++i) {
+        chunk_writer_printf(w, "ser2net_port_active_sessions{tcp_port=\"%u\"} %d\n",
+                            ports[i].tcp_port,
+                            sessions_for_port(ports[i].tcp_port, sessions, session_count));
+    }
+
+#if WS_BRIDGE_ENABLED
+    metric_header(w, "ser2net_ws_bridge_sessions", "gauge", "Open browser terminal sessions.");
+    chunk_writer_printf(w, "ser2net_ws_bridge_sessions %" PRIu32 "\n", s_bridge_sessions);
+    metric_header(w, "ser2net_ws_bridge_bytes_total", "counter", "Bytes relayed by browser terminals.");
+    chunk_writer_printf(w, "ser2net_ws_bridge_bytes_total{direction=\"to_serial\"} %" PRIu32 "\n",
+                        s_bridge_bytes_to_serial);
+    chunk_writer_printf(w, "ser2net_ws_bridge_bytes_total{direction=\"from_serial\"} %" PRIu32 "\n",
+                        s_bridge_bytes_from_serial);
+#endif
 
-    cJSON_AddBoolToObject(root, "sta_configured", status->sta_configured);
-    cJSON_AddBoolToObject(root, "sta_connected", status->sta_connected);
-    cJSON_AddStringToObject(root, "sta_ssid", status->sta_ssid);
-    cJSON_AddStringToObject(root, "sta_ip", status->sta_ip);
-    cJSON_AddBoolToObject(root, "softap_active", status->ap_active);
-    cJSON_AddBoolToObject(root, "softap_force_disabled", status->ap_force_disabled);
-    cJSON_AddNumberToObject(root, "softap_remaining_seconds", status->ap_remaining_seconds);
-    return root;
+    esp_err_t res = chunk_writer_finish(w);
+    free(w);
+    return res;
 }
 
-static esp_err_t wifi_get_handler(httpd_req_t *req)
+static esp_err_t send_wifi_status(httpd_req_t *req)
 {
     struct net_manager_status status;
     if (!net_manager_get_status(&status))
         return httpd_resp_send_500(req);
 
-    cJSON *root = wifi_status_to_json(&status);
-    if (!root)
+    struct json_writer *jw = json_writer_new(req, NULL);
+    if (!jw)
         return httpd_resp_send_500(req);
 
-    esp_err_t res = send_json_response(req, root, 200);
-    cJSON_Delete(root);
-    return res;
+    wifi_write_json(jw, &status);
+    return json_writer_send(jw);
+}
+
+static esp_err_t wifi_get_handler(httpd_req_t *req)
+{
+    return send_wifi_status(req);
 }
 
 static esp_err_t wifi_post_handler(httpd_req_t *req)
@@ -734,34 +828,13 @@ static esp_err_t wifi_post_handler(httpd_req_t *req)
     if (!changed)
         return send_json_error(req, "400 Bad Request", "no changes supplied");
 
-    struct net_manager_status status;
-    if (!net_manager_get_status(&status))
-        return httpd_resp_send_500(req);
-
-    cJSON *resp = wifi_status_to_json(&status);
-    if (!resp)
-        return httpd_resp_send_500(req);
-
-    esp_err_t res = send_json_response(req, resp, 200);
-    cJSON_Delete(resp);
-    return res;
+    return send_wifi_status(req);
 }
 
 static esp_err_t wifi_delete_handler(httpd_req_t *req)
 {
     net_manager_forget_credentials();
-
-    struct net_manager_status status;
-    if (!net_manager_get_status(&status))
-        return httpd_resp_send_500(req);
-
-    cJSON *resp = wifi_status_to_json(&status);
-    if (!resp)
-        return httpd_resp_send_500(req);
-
-    esp_err_t res = send_json_response(req, resp, 200);
-    cJSON_Delete(resp);
-    return res;
+    return send_wifi_status(req);
 }
 
 static bool parse_port_config(cJSON *root, struct ser2net_esp32_serial_port_cfg *cfg)
@@ -851,13 +924,9 @@ static bool parse_port_config(cJSON *root, struct ser2net_esp32_serial_port_cfg
 }
 
 #if ENABLE_DYNAMIC_SESSIONS
-static esp_err_t ports_post_handler(httpd_req_t *req)
+static void port_cfg_defaults(struct ser2net_esp32_serial_port_cfg *cfg)
 {
-    cJSON *root = NULL;
-    if (!read_json_body(req, &root))
-        return ESP_OK;
-
-    struct ser2net_esp32_serial_port_cfg cfg = {
+    *cfg = (struct ser2net_esp32_serial_port_cfg) {
         .port_id = -1,
         .uart_num = UART_NUM_MAX,
         .tx_pin = -1,
@@ -875,6 +944,16 @@ static esp_err_t ports_post_handler(httpd_req_t *req)
         .idle_timeout_ms = 0,
         .enabled = true
     };
+}
+
+static esp_err_t ports_post_handler(httpd_req_t *req)
+{
+    cJSON *root = NULL;
+    if (!read_json_body(req, &root))
+        return ESP_OK;
+
+    struct ser2net_esp32_serial_port_cfg cfg;
+    port_cfg_defaults(&cfg);
     bool ok = parse_port_config(root, &cfg);
     cJSON_Delete(root);
     if (!ok)
@@ -885,29 +964,7 @@ static esp_err_t ports_post_handler(httpd_req_t *req)
         return httpd_resp_send(req, "{\"error\":\"port exists or invalid\"}", HTTPD_RESP_USE_STRLEN);
     }
 
-    struct ser2net_esp32_serial_port_cfg snapshot[SER2NET_MAX_PORTS];
-    size_t count = ser2net_runtime_copy_ports(snapshot, SER2NET_MAX_PORTS);
-    struct ser2net_active_session sessions[SER2NET_MAX_PORTS];
-    size_t session_count = ser2net_runtime_list_sessions(sessions, SER2NET_MAX_PORTS);
-
-    const struct ser2net_esp32_serial_port_cfg *added = NULL;
-    for (size_t i = 0; i < count; ++i) {
-        if (snapshot[i].tcp_port == cfg.tcp_port) {
-            added = &snapshot[i];
-            break;
-        }
-    }
-
-    if (!added)
-        return httpd_resp_send_500(req);
-
-    cJSON *resp = port_to_json(added, sessions_for_port(added->tcp_port, sessions, session_count));
-    if (!resp)
-        return httpd_resp_send_500(req);
-
-esp_err_t res = send_json_response(req, resp, 201);
-    cJSON_Delete(resp);
-    return res;
+    return send_port_response(req, cfg.tcp_port, "201 Created");
 }
 #else
 static esp_err_t ports_post_handler(httpd_req_t *req)
@@ -920,59 +977,64 @@ static esp_err_t ports_post_handler(httpd_req_t *req)
 #endif
 
 #if ENABLE_DYNAMIC_SESSIONS
-static esp_err_t port_config_handler(httpd_req_t *req, uint16_t tcp_port)
-{
-    struct ser2net_esp32_serial_port_cfg ports[SER2NET_MAX_PORTS];
-    size_t count = ser2net_runtime_copy_ports(ports, SER2NET_MAX_PORTS);
-    const struct ser2net_esp32_serial_port_cfg *base = find_port_by_tcp(tcp_port, ports, count);
-    if (!base)
-        return send_json_error(req, "404 Not Found", "port not found");
-
-    cJSON *root = NULL;
-    if (!read_json_body(req, &root))
-        return ESP_OK;
-
+struct port_update {
     struct ser2net_serial_params params;
-    fill_params_from_cfg(base, &params);
-    uint32_t idle_timeout = base->idle_timeout_ms;
-    bool apply_active = false;
-    struct ser2net_pin_config pins = {
+    uint32_t idle_timeout;
+    bool apply_active;
+    struct ser2net_pin_config pins;
+    bool pins_updated;
+};
+
+static void port_update_init(const struct ser2net_esp32_serial_port_cfg *base,
+                             struct port_update *out)
+{
+    fill_params_from_cfg(base, &out->params);
+    out->idle_timeout = base->idle_timeout_ms;
+    out->apply_active = false;
+    out->pins = (struct ser2net_pin_config) {
         .uart_num = base->uart_num,
         .tx_pin = base->tx_pin,
         .rx_pin = base->rx_pin,
         .rts_pin = base->rts_pin,
         .cts_pin = base->cts_pin
     };
-    bool pins_updated = false;
+    out->pins_updated = false;
+}
+
+/* Fill @out from @base plus the fields present in @root.  Returns NULL on
+ * success or the message for a 400 response. */
+static const char *parse_port_update(cJSON *root,
+                                     const struct ser2net_esp32_serial_port_cfg *base,
+                                     struct port_update *out)
+{
+    port_update_init(base, out);
 
     cJSON *baud = cJSON_GetObjectItemCaseSensitive(root, "baud");
     if (cJSON_IsNumber(baud) && baud->valueint > 0)
-        params.baud = baud->valueint;
+        out->params.baud = baud->valueint;
 
     cJSON *data_bits = cJSON_GetObjectItemCaseSensitive(root, "data_bits");
     if (cJSON_IsNumber(data_bits)) {
         switch (data_bits->valueint) {
-        case 5: params.data_bits = 5; break;
-        case 6: params.data_bits = 6; break;
-        case 7: params.data_bits = 7; break;
-        case 8: params.data_bits = 8; break;
+        case 5: out->params.data_bits = 5; break;
+        case 6: out->params.data_bits = 6; break;
+        case 7: out->params.data_bits = 7; break;
+        case 8: out->params.data_bits = 8; break;
         default:
-            cJSON_Delete(root);
-            return send_json_error(req, "400 Bad Request", "data_bits must be 5-8");
+            return "data_bits must be 5-8";
         }
     }
 
     cJSON *parity = cJSON_GetObjectItemCaseSensitive(root, "parity");
     if (cJSON_IsString(parity) && parity->valuestring) {
         if (strcasecmp(parity->valuestring, "odd") == 0)
-            params.parity = 1;
+            out->params.parity = 1;
         else if (strcasecmp(parity->valuestring, "even") == 0)
-            params.parity = 2;
+            out->params.parity = 2;
         else if (strcasecmp(parity->valuestring, "none") == 0)
-            params.parity = 0;
+            out->params.parity = 0;
         else {
-            cJSON_Delete(root);
-            return send_json_error(req, "400 Bad Request", "parity must be none/odd/even");
+            return "parity must be none/odd/even";
         }
     }
 
@@ -981,29 +1043,27 @@ static esp_err_t port_config_handler(httpd_req_t *req, uint16_t tcp_port)
         if (cJSON_IsNumber(stop_bits)) {
             double v = stop_bits->valuedouble;
             if (v >= 1.9)
-                params.stop_bits = 2;
+                out->params.stop_bits = 2;
 #ifdef UART_STOP_BITS_1_5
             else if (v > 1.0 && v < 2.0)
-                params.stop_bits = 15;
+                out->params.stop_bits = 15;
 #endif
             else if (v >= 0.9 && v <= 1.1)
-                params.stop_bits = 1;
+                out->params.stop_bits = 1;
             else {
-                cJSON_Delete(root);
-                return send_json_error(req, "400 Bad Request", "stop_bits must be 1/1.5/2");
+                return "stop_bits must be 1/1.5/2";
             }
         } else if (cJSON_IsString(stop_bits) && stop_bits->valuestring) {
             if (strcmp(stop_bits->valuestring, "2") == 0)
-                params.stop_bits = 2;
+                out->params.stop_bits = 2;
 #ifdef UART_STOP_BITS_1_5
             else if (strcmp(stop_bits->valuestring, "1.5") == 0)
-                params.stop_bits = 15;
+                out->params.stop_bits = 15;
 #endif
             else if (strcmp(stop_bits->valuestring, "1") == 0)
-                params.stop_bits = 1;
+                out->params.stop_bits = 1;
             else {
-                cJSON_Delete(root);
-                return send_json_error(req, "400 Bad Request", "stop_bits must be 1/1.5/2");
+                return "stop_bits must be 1/1.5/2";
             }
         }
     }
@@ -1011,78 +1071,82 @@ static esp_err_t port_config_handler(httpd_req_t *req, uint16_t tcp_port)
     cJSON *flow = cJSON_GetObjectItemCaseSensitive(root, "flow_control");
     if (cJSON_IsString(flow) && flow->valuestring) {
         if (strcasecmp(flow->valuestring, "rtscts") == 0)
-            params.flow_control = 1;
+            out->params.flow_control = 1;
         else if (strcasecmp(flow->valuestring, "none") == 0)
-            params.flow_control = 0;
+            out->params.flow_control = 0;
         else {
-            cJSON_Delete(root);
-            return send_json_error(req, "400 Bad Request", "flow_control must be none or rtscts");
+            return "flow_control must be none or rtscts";
         }
     }
 
     cJSON *idle = cJSON_GetObjectItemCaseSensitive(root, "idle_timeout_ms");
     if (cJSON_IsNumber(idle)) {
         if (idle->valueint < 0) {
-            cJSON_Delete(root);
-            return send_json_error(req, "400 Bad Request", "idle_timeout_ms must be >= 0");
+            return "idle_timeout_ms must be >= 0";
         }
-        idle_timeout = (uint32_t) idle->valueint;
+        out->idle_timeout = (uint32_t) idle->valueint;
     }
 
     cJSON *apply = cJSON_GetObjectItemCaseSensitive(root, "apply_active");
     if (cJSON_IsBool(apply))
-        apply_active = cJSON_IsTrue(apply);
+        out->apply_active = cJSON_IsTrue(apply);
 
     cJSON *tx = cJSON_GetObjectItemCaseSensitive(root, "tx_pin");
     if (cJSON_IsNumber(tx)) {
-        pins.tx_pin = tx->valueint;
-        pins_updated = true;
+        out->pins.tx_pin = tx->valueint;
+        out->pins_updated = true;
     }
     cJSON *rx = cJSON_GetObjectItemCaseSensitive(root, "rx_pin");
     if (cJSON_IsNumber(rx)) {
-        pins.rx_pin = rx->valueint;
-        pins_updated = true;
+        out->pins.rx_pin = rx->valueint;
+        out->pins_updated = true;
     }
     cJSON *rts = cJSON_GetObjectItemCaseSensitive(root, "rts_pin");
     if (cJSON_IsNumber(rts)) {
-        pins.rts_pin = rts->valueint >= 0 ? rts->valueint : INT_MIN;
-        pins_updated = true;
+        out->pins.rts_pin = rts->valueint >= 0 ? rts->valueint : INT_MIN;
+        out->pins_updated = true;
     }
     cJSON *cts = cJSON_GetObjectItemCaseSensitive(root, "cts_pin");
     if (cJSON_IsNumber(cts)) {
-        pins.cts_pin = cts->valueint >= 0 ? cts->valueint : INT_MIN;
-        pins_updated = true;
+        out->pins.cts_pin = cts->valueint >= 0 ? cts->valueint : INT_MIN;
+        out->pins_updated = true;
     }
 
     cJSON *uart_new = cJSON_GetObjectItemCaseSensitive(root, "uart");
     if (cJSON_IsNumber(uart_new)) {
-        pins.uart_num = uart_new->valueint;
-        pins_updated = true;
+        out->pins.uart_num = uart_new->valueint;
+        out->pins_updated = true;
     }
 
+    return NULL;
+}
+
+static esp_err_t port_config_handler(httpd_req_t *req, uint16_t tcp_port)
+{
+    struct ser2net_esp32_serial_port_cfg ports[SER2NET_MAX_PORTS];
+    size_t count = ser2net_runtime_copy_ports(ports, SER2NET_MAX_PORTS);
+    const struct ser2net_esp32_serial_port_cfg *base = find_port_by_tcp(tcp_port, ports, count);
+    if (!base)
+        return send_json_error(req, "404 Not Found", "port not found");
+
+    cJSON *root = NULL;
+    if (!read_json_body(req, &root))
+        return ESP_OK;
+
+    struct port_update update;
+    const char *error = parse_port_update(root, base, &update);
     cJSON_Delete(root);
+    if (error)
+        return send_json_error(req, "400 Bad Request", error);
 
     if (ser2net_runtime_update_serial_config(tcp_port,
-                                             &params,
-                                             idle_timeout,
-                                             apply_active,
-                                             pins_updated ? &pins : NULL) != pdPASS)
+                                             &update.params,
+                                             update.idle_timeout,
+                                             update.apply_active,
+                                             update.pins_updated ? &update.pins : NULL) != pdPASS)
         return send_json_error(req, "409 Conflict", "unable to update port");
 
-    struct ser2net_active_session sessions[SER2NET_MAX_PORTS];
-    size_t session_count = ser2net_runtime_list_sessions(sessions, SER2NET_MAX_PORTS);
-    count = ser2net_runtime_copy_ports(ports, SER2NET_MAX_PORTS);
-    base = find_port_by_tcp(tcp_port, ports, count);
-    if (!base)
-        return httpd_resp_send_500(req);
-
-    cJSON *resp = port_to_json(base, sessions_for_port(base->tcp_port, sessions, session_count));
-    if (!resp)
-        return httpd_resp_send_500(req);
-
-    esp_err_t res = send_json_response(req, resp, 200);
-    cJSON_Delete(resp);
-    return res;
+    return send_port_response(req, tcp_port, NULL);
 }
 #else
 static esp_err_t port_config_handler(httpd_req_t *req, uint16_t tcp_port)
@@ -1096,55 +1160,53 @@ static esp_err_t port_config_handler(httpd_req_t *req, uint16_t tcp_port)
 #endif
 
 #if ENABLE_DYNAMIC_SESSIONS
-static esp_err_t port_mode_handler(httpd_req_t *req, uint16_t tcp_port)
+static const char *parse_mode_update(cJSON *root,
+                                     const struct ser2net_esp32_serial_port_cfg *base,
+                                     enum ser2net_port_mode *mode, bool *enabled)
 {
-    struct ser2net_esp32_serial_port_cfg ports[SER2NET_MAX_PORTS];
-    size_t count = ser2net_runtime_copy_ports(ports, SER2NET_MAX_PORTS);
-    const struct ser2net_esp32_serial_port_cfg *base = find_port_by_tcp(tcp_port, ports, count);
-    if (!base)
-        return send_json_error(req, "404 Not Found", "port not found");
-
-    cJSON *root = NULL;
-    if (!read_json_body(req, &root))
-        return ESP_OK;
-
-    enum ser2net_port_mode mode = base->mode;
-    bool enabled = base->enabled;
+    *mode = base->mode;
+    *enabled = base->enabled;
     bool touched = false;
 
     cJSON *mode_item = cJSON_GetObjectItemCaseSensitive(root, "mode");
     if (cJSON_IsString(mode_item) && mode_item->valuestring) {
-        mode = port_mode_from_str(mode_item->valuestring);
+        *mode = port_mode_from_str(mode_item->valuestring);
         touched = true;
     }
 
     cJSON *enabled_item = cJSON_GetObjectItemCaseSensitive(root, "enabled");
     if (cJSON_IsBool(enabled_item)) {
-        enabled = cJSON_IsTrue(enabled_item);
+        *enabled = cJSON_IsTrue(enabled_item);
         touched = true;
     }
 
-    cJSON_Delete(root);
-
-    if (!touched)
-        return send_json_error(req, "400 Bad Request", "mode or enabled required");
-
-    if (ser2net_runtime_set_port_mode(tcp_port, mode, enabled) != pdPASS)
-        return send_json_error(req, "409 Conflict", "unable to update mode");
+    return touched ? NULL : "mode or enabled required";
+}
 
-    struct ser2net_active_session sessions[SER2NET_MAX_PORTS];
-    size_t session_count = ser2net_runtime_list_sessions(sessions, SER2NET_MAX_PORTS);
-    count = ser2net_runtime_copy_ports(ports, SER2NET_MAX_PORTS);
-    base = find_port_by_tcp(tcp_port, ports, count);
+static esp_err_t port_mode_handler(httpd_req_t *req, uint16_t tcp_port)
+{
+    struct ser2net_esp32_serial_port_cfg ports[SER2NET_MAX_PORTS];
+    size_t count = ser2net_runtime_copy_ports(ports, SER2NET_MAX_PORTS);
+    const struct ser2net_esp32_serial_port_cfg *base = find_port_by_tcp(tcp_port, ports, count);
     if (!base)
-        return httpd_resp_send_500(req);
+        return send_json_error(req, "404 Not Found", "port not found");
 
-    cJSON *resp = port_to_json(base, sessions_for_port(base->tcp_port, sessions, session_count));
-    if (!resp)
-        return httpd_resp_send_500(req);
-    esp_err_t res = send_json_response(req, resp, 200);
-    cJSON_Delete(resp);
-    return res;
+    cJSON *root = NULL;
+    if (!read_json_body(req, &root))
+        return ESP_OK;
+
+    enum ser2net_port_mode mode;
+    bool enabled;
+    const char *error = parse_mode_update(root, base, &mode, &enabled);
+    cJSON_Delete(root);
+
+    if (error)
+        return send_json_error(req, "400 Bad Request", error);
+
+    if (ser2net_runtime_set_port_mode(tcp_port, mode, enabled) != pdPASS)
+        return send_json_error(req, "409 Conflict", "unable to update mode");
+
+    return send_port_response(req, tcp_port, NULL);
 }
 #else
 static esp_err_t port_mode_handler(httpd_req_t *req, uint16_t tcp_port)
@@ -1230,6 +1292,1519 @@ static esp_err_t ports_delete_handler(httpd_req_t *req)
 }
 #endif
 
+#if ENABLE_DYNAMIC_SESSIONS
+/*
+ * PATCH /api/ports: a JSON array of create/update/mode/delete items.  Every
+ * item is validated against a copy of the port list that earlier items have
+ * already been applied to, so "create 4002, then set its mode" works.  Only a
+ * fully valid batch reaches the runtime, and the persistence callbacks it
+ * triggers are folded into one NVS write via config_store_begin_batch().  If
+ * the runtime refuses an item anyway, the items before it are undone from
+ * the port state recorded during validation, so the batch stays atomic.
+ */
+enum batch_op_kind {
+    BATCH_OP_CREATE,
+    BATCH_OP_UPDATE,
+    BATCH_OP_MODE,
+    BATCH_OP_DELETE,
+    BATCH_OP_COUNT
+};
+
+static const char *const s_batch_op_names[BATCH_OP_COUNT] = {
+    "create", "update", "mode", "delete"
+};
+
+struct batch_op {
+    enum batch_op_kind kind;
+    uint16_t tcp_port;
+    const char *error;
+    struct ser2net_esp32_serial_port_cfg prev; /* port before this item */
+    union {
+        struct ser2net_esp32_serial_port_cfg create;
+        struct port_update update;
+        struct {
+            enum ser2net_port_mode mode;
+            bool enabled;
+        } mode;
+    } u;
+};
+
+struct batch_ctx {
+    struct ser2net_esp32_serial_port_cfg ports[SER2NET_MAX_PORTS];
+    size_t port_count;
+    struct batch_op ops[BATCH_MAX_OPS];
+    size_t op_count;
+};
+
+static struct ser2net_esp32_serial_port_cfg *batch_find(struct batch_ctx *ctx, uint16_t tcp_port)
+{
+    for (size_t i = 0; i < ctx->port_count; ++i) {
+        if (ctx->ports[i].tcp_port == tcp_port)
+            return &ctx->ports[i];
+    }
+    return NULL;
+}
+
+/* Inverse of fill_params_from_cfg(), so a later item in the same batch starts
+ * from the values an earlier update left behind. */
+static void port_update_to_cfg(const struct port_update *update,
+                               struct ser2net_esp32_serial_port_cfg *cfg)
+{
+    cfg->baud_rate = update->params.baud;
+    switch (update->params.data_bits) {
+    case 5: cfg->data_bits = UART_DATA_5_BITS; break;
+    case 6: cfg->data_bits = UART_DATA_6_BITS; break;
+    case 7: cfg->data_bits = UART_DATA_7_BITS; break;
+    default: cfg->data_bits = UART_DATA_8_BITS; break;
+    }
+    if (update->params.parity == 1)
+        cfg->parity = UART_PARITY_ODD;
+    else if (update->params.parity == 2)
+        cfg->parity = UART_PARITY_EVEN;
+    else
+        cfg->parity = UART_PARITY_DISABLE;
+
+    switch (update->params.stop_bits) {
+    case 2: cfg->stop_bits = UART_STOP_BITS_2; break;
+#ifdef UART_STOP_BITS_1_5
+    case 15: cfg->stop_bits = UART_STOP_BITS_1_5; break;
+#endif
+    default: cfg->stop_bits = UART_STOP_BITS_1; break;
+    }
+
+    cfg->flow_ctrl = update->params.flow_control ? UART_HW_FLOWCTRL_CTS_RTS
+                                                 : UART_HW_FLOWCTRL_DISABLE;
+    cfg->idle_timeout_ms = update->idle_timeout;
+    if (update->pins_updated) {
+        cfg->uart_num = update->pins.uart_num;
+        cfg->tx_pin = update->pins.tx_pin;
+        cfg->rx_pin = update->pins.rx_pin;
+        cfg->rts_pin = update->pins.rts_pin;
+        cfg->cts_pin = update->pins.cts_pin;
+    }
+}
+
+static const char *batch_validate(struct batch_ctx *ctx, cJSON *item, struct batch_op *op)
+{
+    op->kind = BATCH_OP_COUNT;
+    if (!cJSON_IsObject(item))
+        return "item must be an object";
+
+    cJSON *kind = cJSON_GetObjectItemCaseSensitive(item, "op");
+    if (!cJSON_IsString(kind) || !kind->valuestring)
+        return "op required";
+    for (int k = 0; k < BATCH_OP_COUNT; ++k) {
+        if (strcmp(kind->valuestring, s_batch_op_names[k]) == 0)
+            op->kind = (enum batch_op_kind) k;
+    }
+    if (op->kind == BATCH_OP_COUNT)
+        return "op must be create/update/mode/delete";
+
+    if (op->kind == BATCH_OP_CREATE) {
+        port_cfg_defaults(&op->u.create);
+        if (!parse_port_config(item, &op->u.create))
+            return "invalid port parameters";
+        op->tcp_port = op->u.create.tcp_port;
+        if (batch_find(ctx, op->tcp_port))
+            return "port exists";
+        if (ctx->port_count >= SER2NET_MAX_PORTS)
+            return "too many ports";
+        ctx->ports[ctx->port_count++] = op->u.create;
+        return NULL;
+    }
+
+    cJSON *tcp = cJSON_GetObjectItemCaseSensitive(item, "tcp_port");
+    if (!cJSON_IsNumber(tcp) || tcp->valueint <= 0 || tcp->valueint > 65535)
+        return "tcp_port required";
+    op->tcp_port = (uint16_t) tcp->valueint;
+
+    struct ser2net_esp32_serial_port_cfg *port = batch_find(ctx, op->tcp_port);
+    if (!port)
+        return "port not found";
+    op->prev = *port;
+
+    const char *error = NULL;
+    switch (op->kind) {
+    case BATCH_OP_UPDATE:
+        error = parse_port_update(item, port, &op->u.update);
+        if (!error)
+            port_update_to_cfg(&op->u.update, port);
+        break;
+    case BATCH_OP_MODE:
+        error = parse_mode_update(item, port, &op->u.mode.mode, &op->u.mode.enabled);
+        if (!error) {
+            port->mode = op->u.mode.mode;
+            port->enabled = op->u.mode.enabled;
+        }
+        break;
+    default:
+        *port = ctx->ports[--ctx->port_count];
+        break;
+    }
+    return error;
+}
+
+static bool batch_apply(const struct batch_op *op)
+{
+    switch (op->kind) {
+    case BATCH_OP_CREATE:
+        return ser2net_runtime_add_port(&op->u.create) == pdPASS;
+    case BATCH_OP_UPDATE:
+        return ser2net_runtime_update_serial_config(op->tcp_port,
+                                                    &op->u.update.params,
+                                                    op->u.update.idle_timeout,
+                                                    op->u.update.apply_active,
+                                                    op->u.update.pins_updated ?
+                                                    &op->u.update.pins : NULL) == pdPASS;
+    case BATCH_OP_MODE:
+        return ser2net_runtime_set_port_mode(op->tcp_port, op->u.mode.mode,
+                                             op->u.mode.enabled) == pdPASS;
+    default:
+        return ser2net_runtime_remove_port(op->tcp_port) == pdPASS;
+    }
+}
+
+static bool batch_revert(const struct batch_op *op)
+{
+    struct port_update undo;
+    switch (op->kind) {
+    case BATCH_OP_CREATE:
+        return ser2net_runtime_remove_port(op->tcp_port) == pdPASS;
+    case BATCH_OP_UPDATE:
+        port_update_init(&op->prev, &undo);
+        undo.apply_active = op->u.update.apply_active;
+        undo.pins_updated = op->u.update.pins_updated;
+        return ser2net_runtime_update_serial_config(op->tcp_port, &undo.params,
+                                                    undo.idle_timeout,
+                                                    undo.apply_active,
+                                                    undo.pins_updated ? &undo.pins : NULL) == pdPASS;
+    case BATCH_OP_MODE:
+        return ser2net_runtime_set_port_mode(op->tcp_port, op->prev.mode,
+                                             op->prev.enabled) == pdPASS;
+    default:
+        return ser2net_runtime_add_port(&op->prev) == pdPASS;
+    }
+}
+
+static esp_err_t ports_patch_handler(httpd_req_t *req)
+{
+    cJSON *root = NULL;
+    if (!read_json_body_limit(req, &root, BATCH_MAX_BODY))
+        return ESP_OK;
+
+    int item_count = cJSON_IsArray(root) ? cJSON_GetArraySize(root) : 0;
+    if (item_count <= 0 || item_count > BATCH_MAX_OPS) {
+        cJSON_Delete(root);
+        return send_json_error(req, "400 Bad Request", "expected an array of 1-16 operations");
+    }
+
+    struct batch_ctx *ctx = calloc(1, sizeof(*ctx));
+    if (!ctx) {
+        cJSON_Delete(root);
+        return httpd_resp_send_500(req);
+    }
+    ctx->port_count = ser2net_runtime_copy_ports(ctx->ports, SER2NET_MAX_PORTS);
+
+    bool valid = true;
+    cJSON *item = NULL;
+    cJSON_ArrayForEach(item, root) {
+        struct batch_op *op = &ctx->ops[ctx->op_count++];
+        op->error = batch_validate(ctx, item, op);
+        if (op->error)
+            valid = false;
+    }
+    cJSON_Delete(root);
+
+    size_t applied = 0;
+    size_t reverted = 0;
+    bool persisted = false;
+    int64_t apply_us = 0;
+    if (valid) {
+        int64_t start = esp_timer_get_time();
+        config_store_begin_batch();
+        for (; applied < ctx->op_count; ++applied) {
+            if (!batch_apply(&ctx->ops[applied])) {
+                ctx->ops[applied].error = "rejected by runtime";
+                break;
+            }
+        }
+        if (applied < ctx->op_count) {
+            /* Undo newest first; each revert restores the state the next
+             * older item was validated against. */
+            while (applied > 0 && batch_revert(&ctx->ops[applied - 1])) {
+                applied--;
+                reverted++;
+            }
+        }
+        /* A refused batch still closes its config_store batch, which saves
+         * the restored state, but only a complete batch counts as persisted. */
+        persisted = config_store_end_batch() && applied == ctx->op_count;
+        apply_us = esp_timer_get_time() - start;
+    }
+
+    const char *status = !valid ? "400 Bad Request" :
+                         applied < ctx->op_count ? "409 Conflict" : NULL;
+    struct json_writer *jw = json_writer_new(req, status);
+    if (!jw) {
+        free(ctx);
+        return httpd_resp_send_500(req);
+    }
+
+    json_begin_object(jw);
+    json_number(jw, "applied", (double) applied);
+    json_number(jw, "reverted", (double) reverted);
+    json_bool(jw, "persisted", persisted);
+    json_number(jw, "apply_time_us", (double) apply_us);
+    json_key(jw, "results");
+    json_begin_array(jw);
+    for (size_t i = 0; i < ctx->op_count; ++i) {
+        const struct batch_op *op = &ctx->ops[i];
+        json_begin_object(jw);
+        if (op->kind < BATCH_OP_COUNT)
+            json_string(jw, "op", s_batch_op_names[op->kind]);
+        if (op->tcp_port)
+            json_number(jw, "tcp_port", op->tcp_port);
+        if (op->error) {
+            json_string(jw, "status", "error");
+            json_string(jw, "error", op->error);
+        } else {
+            json_string(jw, "status", i < applied ? "ok" :
+                                      i < applied + reverted ? "reverted" : "skipped");
+        }
+        json_end_object(jw);
+    }
+    json_end_array(jw);
+    json_end_object(jw);
+
+    free(ctx);
+    return json_writer_send(jw);
+}
+#else
+static esp_err_t ports_patch_handler(httpd_req_t *req)
+{
+    cJSON *root = NULL;
+    if (read_json_body_limit(req, &root, BATCH_MAX_BODY))
+        cJSON_Delete(root);
+    return send_json_error(req, "403 Forbidden", "dynamic sessions disabled");
+}
+#endif
+
+/*
+ * Server-Sent Events: one task samples the port list, the session set and the
+ * Wi-Fi status and pushes a resource to a client when it changed, at most once
+ * per EVENTS_MIN_INTERVAL_MS per client.  Each event carries the same JSON as
+ * the corresponding GET endpoint.  Streams are detached from the httpd task
+ * with httpd_req_async_handler_begin(), so they do not block other requests.
+ * Sends happen outside s_events_lock on slots marked busy, but all streams
+ * share this one task, so a client that stops reading would hold up everyone
+ * else's updates for a whole send timeout.  A client is therefore only sent
+ * to while its socket has room, and it is dropped once a send takes longer
+ * than EVENTS_SLOW_SEND_MS or its socket stays full for EVENTS_STALL_MS; the
+ * browser reconnects by itself.
+ */
+enum {
+    EVENT_PORTS = 1 << 0,
+    EVENT_SYSTEM = 1 << 1,
+    EVENT_WIFI = 1 << 2,
+    EVENT_ALL = EVENT_PORTS | EVENT_SYSTEM | EVENT_WIFI
+};
+
+struct events_client {
+    httpd_req_t *req;
+    uint8_t pending;
+    bool busy;              /* a send is in progress without the lock */
+    int64_t last_send_us;
+    int64_t full_since_us;  /* when the socket was first seen full, 0 if not */
+};
+
+struct events_due {
+    size_t slot;
+    httpd_req_t *req;
+    uint8_t pending;
+    bool ok;
+};
+
+struct events_snapshot {
+    struct ser2net_esp32_serial_port_cfg ports[SER2NET_MAX_PORTS];
+    size_t port_count;
+    struct ser2net_active_session sessions[SER2NET_MAX_PORTS];
+    size_t session_count;
+    struct net_manager_status wifi;
+    struct json_writer jw;
+};
+
+static SemaphoreHandle_t s_events_lock;
+static struct events_client s_events_clients[EVENTS_MAX_CLIENTS];
+static bool s_events_running;
+
+static bool socket_writable(int fd)
+{
+    fd_set wfds;
+    FD_ZERO(&wfds);
+    FD_SET(fd, &wfds);
+    struct timeval tv = { 0 };
+    return select(fd + 1, NULL, &wfds, NULL, &tv) > 0;
+}
+
+static esp_err_t events_send(httpd_req_t *req, uint8_t pending, struct events_snapshot *snap)
+{
+    struct json_writer *jw = &snap->jw;
+    memset(jw, 0, sizeof(*jw));
+    jw->out.req = req;
+
+    if (pending & EVENT_PORTS) {
+        chunk_writer_printf(&jw->out, "event: ports\ndata: ");
+        ports_write_json(jw, snap->ports, snap->port_count, snap->sessions, snap->session_count);
+        chunk_writer_printf(&jw->out, "\n\n");
+    }
+    if (pending & EVENT_SYSTEM) {
+        chunk_writer_printf(&jw->out, "event: system\ndata: ");
+        system_write_json(jw, snap->port_count, snap->session_count);
+        chunk_writer_printf(&jw->out, "\n\n");
+    }
+    if (pending & EVENT_WIFI) {
+        chunk_writer_printf(&jw->out, "event: wifi\ndata: ");
+        wifi_write_json(jw, &snap->wifi);
+        chunk_writer_printf(&jw->out, "\n\n");
+    }
+    if (!pending)
+        chunk_writer_printf(&jw->out, ": keepalive\n\n");
+    chunk_writer_flush(&jw->out);
+    return jw->out.err;
+}
+
+static void events_task(void *arg)
+{
+    (void) arg;
+    struct events_snapshot *snap = calloc(1, sizeof(*snap));
+    uint32_t last_generation = 0;
+    uint32_t last_fingerprint = 0;
+    struct net_manager_status last_wifi = {0};
+    int64_t last_system_us = 0;
+    bool first = true;
+
+    while (snap) {
+        int64_t now = esp_timer_get_time();
+        uint8_t dirty = 0;
+
+        snap->session_count = ser2net_runtime_list_sessions(snap->sessions, SER2NET_MAX_PORTS);
+        uint32_t generation = __atomic_load_n(&s_config_generation, __ATOMIC_RELAXED);
+        uint32_t fingerprint = sessions_fingerprint(snap->sessions, snap->session_count);
+        if (first || generation != last_generation || fingerprint != last_fingerprint) {
+            snap->port_count = ser2net_runtime_copy_ports(snap->ports, SER2NET_MAX_PORTS);
+            last_generation = generation;
+            last_fingerprint = fingerprint;
+            dirty |= EVENT_PORTS | EVENT_SYSTEM;
+        }
+
+        /* The SoftAP countdown ticks every second; it rides along with the
+         * periodic system event instead of counting as a change. */
+        if (net_manager_get_status(&snap->wifi)) {
+            struct net_manager_status cmp = snap->wifi;
+            cmp.ap_remaining_seconds = last_wifi.ap_remaining_seconds;
+            if (first || memcmp(&cmp, &last_wifi, sizeof(cmp)) != 0)
+                dirty |= EVENT_WIFI;
+            last_wifi = snap->wifi;
+        }
+
+        if (now - last_system_us >= EVENTS_SYSTEM_INTERVAL_MS * 1000LL) {
+            last_system_us = now;
+            dirty |= EVENT_SYSTEM;
+            if (snap->wifi.ap_active)
+                dirty |= EVENT_WIFI;
+        }
+        first = false;
+
+        struct events_due due[EVENTS_MAX_CLIENTS];
+        size_t due_count = 0;
+        bool active = false;
+        xSemaphoreTake(s_events_lock, portMAX_DELAY);
+        for (size_t i = 0; i < EVENTS_MAX_CLIENTS; ++i) {
+            struct events_client *client = &s_events_clients[i];
+            if (!client->req)
+                continue;
+            active = true;
+            client->pending |= dirty;
+            if (client->busy)
+                continue;
+            int64_t idle = now - client->last_send_us;
+            if (client->pending ? idle < EVENTS_MIN_INTERVAL_MS * 1000LL
+                                : idle < EVENTS_KEEPALIVE_MS * 1000LL)
+                continue;
+            if (!socket_writable(httpd_req_to_sockfd(client->req))) {
+                if (!client->full_since_us) {
+                    client->full_since_us = now;
+                } else if (now - client->full_since_us > EVENTS_STALL_MS * 1000LL) {
+                    ESP_LOGW(TAG, "Events: dropping a client that stopped reading");
+                    httpd_req_async_handler_complete(client->req);
+                    client->req = NULL;
+                }
+                continue;
+            }
+            client->full_since_us = 0;
+            client->busy = true;
+            due[due_count++] = (struct events_due) {
+                .slot = i, .req = client->req, .pending = client->pending
+            };
+        }
+        if (!active)
+            s_events_running = false;
+        xSemaphoreGive(s_events_lock);
+
+        if (!active)
+            break;
+
+        for (size_t i = 0; i < due_count; ++i) {
+            int64_t begin = esp_timer_get_time();
+            due[i].ok = events_send(due[i].req, due[i].pending, snap) == ESP_OK;
+            if (due[i].ok && esp_timer_get_time() - begin > EVENTS_SLOW_SEND_MS * 1000LL) {
+                ESP_LOGW(TAG, "Events: dropping a slow client");
+                due[i].ok = false;
+            }
+        }
+
+        if (due_count > 0) {
+            xSemaphoreTake(s_events_lock, portMAX_DELAY);
+            for (size_t i = 0; i < due_count; ++i) {
+                struct events_client *client = &s_events_clients[due[i].slot];
+                client->busy = false;
+                if (!due[i].ok) {
+                    httpd_req_async_handler_complete(client->req);
+                    client->req = NULL;
+                    continue;
+                }
+                /* Keep whatever changed while the send was in flight. */
+                client->pending &= (uint8_t) ~due[i].pending;
+                client->last_send_us = now;
+            }
+            xSemaphoreGive(s_events_lock);
+        }
+        vTaskDelay(pdMS_TO_TICKS(EVENTS_POLL_MS));
+    }
+
+    if (!snap) {
+        ESP_LOGE(TAG, "Events: out of memory");
+        xSemaphoreTake(s_events_lock, portMAX_DELAY);
+        for (size_t i = 0; i < EVENTS_MAX_CLIENTS; ++i) {
+            if (s_events_clients[i].req) {
+                httpd_req_async_handler_complete(s_events_clients[i].req);
+                s_events_clients[i].req = NULL;
+            }
+        }
+        s_events_running = false;
+        xSemaphoreGive(s_events_lock);
+    }
+    free(snap);
+    vTaskDelete(NULL);
+}
+
+static esp_err_t events_handler(httpd_req_t *req)
+{
+    const char *error = NULL;
+    httpd_req_t *stream = NULL;
+    xSemaphoreTake(s_events_lock, portMAX_DELAY);
+    struct events_client *slot = NULL;
+    for (size_t i = 0; i < EVENTS_MAX_CLIENTS && !slot; ++i) {
+        if (!s_events_clients[i].req)
+            slot = &s_events_clients[i];
+    }
+    if (!slot) {
+        error = "too many event streams";
+    } else if (httpd_req_async_handler_begin(req, &stream) != ESP_OK) {
+        error = "unable to detach request";
+    } else {
+        /* Reserve the slot; the events task leaves busy slots alone. */
+        *slot = (struct events_client) {
+            .req = stream, .pending = EVENT_ALL, .busy = true
+        };
+    }
+    xSemaphoreGive(s_events_lock);
+
+    if (error)
+        return send_json_error(req, "503 Service Unavailable", error);
+
+    httpd_resp_set_type(stream, "text/event-stream");
+    httpd_resp_set_hdr(stream, "Cache-Control", "no-cache");
+    bool sent = httpd_resp_send_chunk(stream, "retry: 5000\n\n", HTTPD_RESP_USE_STRLEN) == ESP_OK;
+
+    xSemaphoreTake(s_events_lock, portMAX_DELAY);
+    slot->busy = false;
+    if (sent && !s_events_running) {
+        s_events_running = true;
+        if (xTaskCreate(events_task, "http_events", EVENTS_TASK_STACK,
+                        NULL, tskIDLE_PRIORITY + 2, NULL) != pdPASS) {
+            s_events_running = false;
+            sent = false;
+        }
+    }
+    if (!sent) {
+        httpd_req_async_handler_complete(stream);
+        slot->req = NULL;
+    }
+    xSemaphoreGive(s_events_lock);
+    return ESP_OK;
+}
+
+#if WS_MONITOR_ENABLED
+/*
+ * WebSocket monitor.  The control port already owns the monitor tap that the
+ * session layer feeds via ser2net_control_monitor_feed(), so a relay task
+ * attaches to it over loopback ("monitor <dir> <port>") and fans the stream
+ * out to every subscribed browser.  Each subscriber has its own bounded ring
+ * with drop-oldest semantics and is only written to when its socket can take
+ * data, so a slow tab never blocks the relay or the other subscribers.
+ */
+struct monitor_subscriber {
+    int fd;                 /* -1 marks a free slot */
+    uint8_t *ring;
+    size_t head;
+    size_t used;
+    uint32_t dropped;
+    uint32_t dropped_reported;
+};
+
+static SemaphoreHandle_t s_monitor_lock;
+static struct monitor_subscriber s_monitor_subs[MONITOR_MAX_SUBSCRIBERS];
+static bool s_monitor_running;
+static uint16_t s_monitor_tcp_port;
+static bool s_monitor_term;
+#endif
+
+static uint16_t s_control_port;
+
+void web_server_set_control_port(uint16_t tcp_port)
+{
+    s_control_port = tcp_port;
+}
+
+void web_server_notify_config_changed(void)
+{
+    __atomic_add_fetch(&s_config_generation, 1, __ATOMIC_RELAXED);
+}
+
+#if CONFIG_HTTPD_WS_SUPPORT
+static esp_err_t ws_send_async(int fd, httpd_ws_type_t type, const void *data, size_t len)
+{
+    httpd_ws_frame_t frame = {
+        .final = true,
+        .type = type,
+        .payload = (uint8_t *) data,
+        .len = len
+    };
+    return httpd_ws_send_frame_async(s_server, fd, &frame);
+}
+
+static esp_err_t ws_send_error(httpd_req_t *req, const char *message)
+{
+    char buf[96];
+    int len = snprintf(buf, sizeof(buf), "{\"error\":\"%s\"}", message);
+    httpd_ws_frame_t frame = {
+        .final = true,
+        .type = HTTPD_WS_TYPE_TEXT,
+        .payload = (uint8_t *) buf,
+        .len = (size_t) len
+    };
+    httpd_ws_send_frame(req, &frame);
+    return ESP_FAIL;
+}
+#endif
+
+#if WS_MONITOR_ENABLED
+static void monitor_ring_push(struct monitor_subscriber *sub, const uint8_t *data, size_t len)
+{
+    if (len > MONITOR_RING_SIZE) {
+        sub->dropped += len - MONITOR_RING_SIZE;
+        data += len - MONITOR_RING_SIZE;
+        len = MONITOR_RING_SIZE;
+    }
+
+    size_t space = MONITOR_RING_SIZE - sub->used;
+    if (len > space) {
+        size_t drop = len - space;
+        sub->head = (sub->head + drop) % MONITOR_RING_SIZE;
+        sub->used -= drop;
+        sub->dropped += drop;
+    }
+
+    size_t tail = (sub->head + sub->used) % MONITOR_RING_SIZE;
+    size_t first = MONITOR_RING_SIZE - tail;
+    if (first > len)
+        first = len;
+    memcpy(sub->ring + tail, data, first);
+    memcpy(sub->ring, data + first, len - first);
+    sub->used += len;
+}
+
+static size_t monitor_ring_peek(const struct monitor_subscriber *sub, uint8_t *out, size_t max)
+{
+    size_t len = sub->used < max ? sub->used : max;
+    size_t first = MONITOR_RING_SIZE - sub->head;
+    if (first > len)
+        first = len;
+    memcpy(out, sub->ring + sub->head, first);
+    memcpy(out + first, sub->ring, len - first);
+    return len;
+}
+
+static void monitor_release_slot(struct monitor_subscriber *sub)
+{
+    free(sub->ring);
+    memset(sub, 0, sizeof(*sub));
+    sub->fd = -1;
+}
+
+static int monitor_open_control(uint16_t tcp_port, bool term)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (fd < 0)
+        return -1;
+
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(s_control_port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK)
+    };
+    if (connect(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    /* Swallow the greeting and prompt so only monitored traffic is relayed. */
+    char scratch[64];
+    while (true) {
+        fd_set rfds;
+        FD_ZERO(&rfds);
+        FD_SET(fd, &rfds);
+        struct timeval tv = { .tv_sec = 0, .tv_usec = MONITOR_GREETING_IDLE_MS * 1000 };
+        if (select(fd + 1, &rfds, NULL, NULL, &tv) <= 0)
+            break;
+        if (recv(fd, scratch, sizeof(scratch), 0) <= 0) {
+            close(fd);
+            return -1;
+        }
+    }
+
+    char cmd[32];
+    int len = snprintf(cmd, sizeof(cmd), "monitor %s %u\r\n", term ? "term" : "tcp", tcp_port);
+    if (len <= 0 || send(fd, cmd, (size_t) len, 0) != len) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void monitor_flush_subscribers(uint8_t *frame)
+{
+    for (size_t i = 0; i < MONITOR_MAX_SUBSCRIBERS; ++i) {
+        struct monitor_subscriber *sub = &s_monitor_subs[i];
+
+        xSemaphoreTake(s_monitor_lock, portMAX_DELAY);
+        int fd = sub->fd;
+        if (fd >= 0 && httpd_ws_get_fd_info(s_server, fd) != HTTPD_WS_CLIENT_WEBSOCKET) {
+            monitor_release_slot(sub);
+            fd = -1;
+        }
+        size_t len = 0;
+        uint32_t dropped = 0;
+        if (fd >= 0 && socket_writable(fd)) {
+            len = monitor_ring_peek(sub, frame, MONITOR_FRAME_MAX);
+            if (sub->dropped != sub->dropped_reported)
+                dropped = sub->dropped;
+        } else {
+            fd = -1;
+        }
+        xSemaphoreGive(s_monitor_lock);
+
+        if (fd < 0)
+            continue;
+
+        esp_err_t err = ESP_OK;
+        if (dropped) {
+            char note[40];
+            int n = snprintf(note, sizeof(note), "{\"dropped\":%" PRIu32 "}", dropped);
+            err = ws_send_async(fd, HTTPD_WS_TYPE_TEXT, note, (size_t) n);
+        }
+        if (err == ESP_OK && len > 0)
+            err = ws_send_async(fd, HTTPD_WS_TYPE_BINARY, frame, len);
+
+        xSemaphoreTake(s_monitor_lock, portMAX_DELAY);
+        if (err != ESP_OK) {
+            monitor_release_slot(sub);
+        } else {
+            sub->head = (sub->head + len) % MONITOR_RING_SIZE;
+            sub->used -= len;
+            if (dropped)
+                sub->dropped_reported = dropped;
+        }
+        xSemaphoreGive(s_monitor_lock);
+    }
+}
+
+static void monitor_task(void *arg)
+{
+    (void) arg;
+    uint8_t buf[MONITOR_FRAME_MAX];
+    uint8_t frame[MONITOR_FRAME_MAX];
+
+    int ctl = monitor_open_control(s_monitor_tcp_port, s_monitor_term);
+    if (ctl < 0)
+        ESP_LOGW(TAG, "Monitor: control port %u unreachable", s_control_port);
+
+    /* Set when the last subscriber left and s_monitor_running was cleared
+     * under the lock.  From then on a new subscriber belongs to a new task,
+     * so the cleanup below must not touch the slots. */
+    bool idle = false;
+
+    while (ctl >= 0) {
+        fd_set rfds;
+        FD_ZERO(&rfds);
+        FD_SET(ctl, &rfds);
+        struct timeval tv = { .tv_sec = 0, .tv_usec = MONITOR_POLL_MS * 1000 };
+        int ready = select(ctl + 1, &rfds, NULL, NULL, &tv);
+        int received = 0;
+        if (ready > 0) {
+            received = recv(ctl, buf, sizeof(buf), 0);
+            if (received <= 0)
+                break;
+        }
+
+        bool active = false;
+        xSemaphoreTake(s_monitor_lock, portMAX_DELAY);
+        for (size_t i = 0; i < MONITOR_MAX_SUBSCRIBERS; ++i) {
+            if (s_monitor_subs[i].fd < 0)
+                continue;
+            active = true;
+            if (received > 0)
+                monitor_ring_push(&s_monitor_subs[i], buf, (size_t) received);
+        }
+        if (!active)
+            s_monitor_running = false;
+        xSemaphoreGive(s_monitor_lock);
+
+        if (!active) {
+            idle = true;
+            break;
+        }
+        monitor_flush_subscribers(frame);
+    }
+
+    if (ctl >= 0)
+        close(ctl);
+
+    if (!idle) {
+        /* Control side went away while browsers were still attached. */
+        static const char note[] = "{\"error\":\"control port closed\"}";
+        xSemaphoreTake(s_monitor_lock, portMAX_DELAY);
+        for (size_t i = 0; i < MONITOR_MAX_SUBSCRIBERS; ++i) {
+            if (s_monitor_subs[i].fd >= 0) {
+                ws_send_async(s_monitor_subs[i].fd, HTTPD_WS_TYPE_TEXT, note, sizeof(note) - 1);
+                httpd_sess_trigger_close(s_server, s_monitor_subs[i].fd);
+                monitor_release_slot(&s_monitor_subs[i]);
+            }
+        }
+        s_monitor_running = false;
+        xSemaphoreGive(s_monitor_lock);
+    }
+    vTaskDelete(NULL);
+}
+
+static esp_err_t monitor_subscribe(httpd_req_t *req)
+{
+    if (s_control_port == 0)
+        return ws_send_error(req, "control port disabled");
+
+    char query[48] = {0};
+    char value[8] = {0};
+    long tcp_port = 0;
+    bool term = false;
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (httpd_query_key_value(query, "port", value, sizeof(value)) == ESP_OK)
+            tcp_port = strtol(value, NULL, 10);
+        if (httpd_query_key_value(query, "dir", value, sizeof(value)) == ESP_OK)
+            term = strcmp(value, "term") == 0;
+    }
+
+    struct ser2net_esp32_serial_port_cfg ports[SER2NET_MAX_PORTS];
+    size_t count = ser2net_runtime_copy_ports(ports, SER2NET_MAX_PORTS);
+    if (tcp_port <= 0 || tcp_port > 65535 || !find_port_by_tcp((uint16_t) tcp_port, ports, count))
+        return ws_send_error(req, "port not found");
+
+    const char *error = NULL;
+    xSemaphoreTake(s_monitor_lock, portMAX_DELAY);
+    struct monitor_subscriber *slot = NULL;
+    for (size_t i = 0; i < MONITOR_MAX_SUBSCRIBERS && !slot; ++i) {
+        if (s_monitor_subs[i].fd < 0)
+            slot = &s_monitor_subs[i];
+    }
+    if (s_monitor_running &&
+        (s_monitor_tcp_port != (uint16_t) tcp_port || s_monitor_term != term))
+        error = "monitor busy with another port";
+    else if (!slot)
+        error = "too many monitor clients";
+    else if (!(slot->ring = malloc(MONITOR_RING_SIZE)))
+        error = "out of memory";
+
+    if (!error) {
+        slot->fd = httpd_req_to_sockfd(req);
+        if (!s_monitor_running) {
+            s_monitor_tcp_port = (uint16_t) tcp_port;
+            s_monitor_term = term;
+            s_monitor_running = true;
+            if (xTaskCreate(monitor_task, "ws_monitor", MONITOR_TASK_STACK,
+                            NULL, tskIDLE_PRIORITY + 3, NULL) != pdPASS) {
+                s_monitor_running = false;
+                monitor_release_slot(slot);
+                error = "unable to start monitor";
+            }
+        }
+    }
+    xSemaphoreGive(s_monitor_lock);
+
+    if (error)
+        return ws_send_error(req, error);
+    return ESP_OK;
+}
+
+static esp_err_t ws_monitor_handler(httpd_req_t *req)
+{
+    if (req->method == HTTP_GET)
+        return monitor_subscribe(req);
+
+    /* Subscribers are read-only; drain and ignore anything they send. */
+    httpd_ws_frame_t frame = {0};
+    esp_err_t err = httpd_ws_recv_frame(req, &frame, 0);
+    if (err != ESP_OK || frame.len == 0)
+        return err;
+
+    uint8_t scratch[64];
+    if (frame.len > sizeof(scratch))
+        return ESP_FAIL;
+    frame.payload = scratch;
+    return httpd_ws_recv_frame(req, &frame, frame.len);
+}
+#endif /* WS_MONITOR_ENABLED */
+
+#if WS_BRIDGE_ENABLED
+/*
+ * Browser terminal.  /ws/ports/<tcp> connects to the port's own listener over
+ * loopback, so the runtime accepts it like any other client: the port's mode
+ * and session limit apply unchanged.  WebSocket binary frames are written to
+ * that socket as-is; a bridge task relays whatever the session sends back as
+ * binary frames.  Browser input is queued per bridge and written by the
+ * bridge task only when the session socket takes it, so a slow UART never
+ * blocks the httpd task; input that does not fit is dropped and counted.
+ * connect() completes from the listen backlog whether or not the runtime has
+ * a free session, so a bridge only counts as connected once the runtime lists
+ * one more session on the port than before, or the session sends data; the
+ * browser is told with a {"connected":true} frame.  A bridge that is not
+ * admitted within BRIDGE_ADMIT_TIMEOUT_MS is closed.  A slot is reserved before
+ * that connect(), so a terminal refused for lack of slots never takes a
+ * session from the port.  Frames to the browser are built under
+ * s_bridge_lock but sent without it on a slot marked busy, so a browser that
+ * stops reading holds up the bridge task only, never the httpd task.
+ * In telnet mode the bridge acts as a minimal telnet client:
+ * it escapes 0xFF on the way in, strips IAC sequences on the way out and
+ * only agrees to BINARY and SGA.
+ */
+#define TELNET_SE   240
+#define TELNET_SB   250
+#define TELNET_WILL 251
+#define TELNET_WONT 252
+#define TELNET_DO   253
+#define TELNET_DONT 254
+#define TELNET_IAC  255
+#define TELNET_OPT_BINARY 0
+#define TELNET_OPT_SGA    3
+
+enum telnet_state {
+    TELNET_STATE_DATA,
+    TELNET_STATE_IAC,
+    TELNET_STATE_OPTION,
+    TELNET_STATE_SB,
+    TELNET_STATE_SB_IAC
+};
+
+struct ws_bridge {
+    int ws_fd;              /* -1 marks a free slot */
+    int tcp_fd;
+    bool busy;              /* reserved, or a send is in progress without the lock */
+    bool broken;            /* session socket failed; the bridge task closes it */
+    uint16_t tcp_port;
+    bool admitted;
+    int sessions_before;    /* runtime sessions on the port before connect() */
+    int64_t opened_us;
+    bool telnet;
+    enum telnet_state state;
+    uint8_t verb;
+    uint8_t answered[2][32]; /* DO/DONT and WILL/WONT options already answered */
+    uint8_t *tx;            /* input waiting for the session socket */
+    size_t tx_len;
+    uint32_t to_serial;
+    uint32_t from_serial;
+    uint32_t dropped;
+    uint32_t reported_to;
+    uint32_t reported_from;
+    uint32_t reported_dropped;
+    int64_t last_stats_us;
+};
+
+/* Frames for one bridge, built under s_bridge_lock and sent without it. */
+struct bridge_send {
+    int ws_fd;
+    bool admit;
+    const uint8_t *data;    /* session output in the bridge task's buffer */
+    size_t data_len;
+    char stats[96];
+    size_t stats_len;
+    const char *error;      /* close the bridge after sending this note */
+};
+
+static SemaphoreHandle_t s_bridge_lock;
+static struct ws_bridge s_bridges[BRIDGE_MAX_CLIENTS];
+static bool s_bridge_running;
+/* Frame buffers for the WebSocket -> serial direction; only the httpd task
+ * uses them. */
+static uint8_t s_bridge_in[BRIDGE_FRAME_MAX];
+static uint8_t s_bridge_out[2 * BRIDGE_FRAME_MAX];
+
+static void bridge_release(struct ws_bridge *bridge)
+{
+    if (bridge->tcp_fd >= 0)
+        close(bridge->tcp_fd);
+    free(bridge->tx);
+    bridge->tx = NULL;
+    bridge->tcp_fd = -1;
+    bridge->ws_fd = -1;
+    s_bridge_sessions--;
+}
+
+static void telnet_answer(struct ws_bridge *bridge, uint8_t verb, uint8_t opt,
+                          uint8_t *reply, size_t *reply_len)
+{
+    bool our_side = verb == TELNET_DO || verb == TELNET_DONT;
+    uint8_t *answered = bridge->answered[our_side ? 0 : 1];
+    uint8_t bit = (uint8_t) (1u << (opt % 8));
+    /* Answer each option once; that is enough to never loop. */
+    if (answered[opt / 8] & bit)
+        return;
+    answered[opt / 8] |= bit;
+
+    bool accept = (verb == TELNET_DO || verb == TELNET_WILL) &&
+                  (opt == TELNET_OPT_BINARY || opt == TELNET_OPT_SGA);
+    if (*reply_len + 3 > BRIDGE_FRAME_MAX)
+        return;
+    reply[(*reply_len)++] = TELNET_IAC;
+    if (our_side)
+        reply[(*reply_len)++] = accept ? TELNET_WILL : TELNET_WONT;
+    else
+        reply[(*reply_len)++] = accept ? TELNET_DO : TELNET_DONT;
+    reply[(*reply_len)++] = opt;
+}
+
+/* Strip telnet commands from @data in place; returns the payload length. */
+static size_t telnet_filter(struct ws_bridge *bridge, uint8_t *data, size_t len,
+                            uint8_t *reply, size_t *reply_len)
+{
+    size_t out = 0;
+    for (size_t i = 0; i < len; ++i) {
+        uint8_t c = data[i];
+        switch (bridge->state) {
+        case TELNET_STATE_DATA:
+            if (c == TELNET_IAC)
+                bridge->state = TELNET_STATE_IAC;
+            else
+                data[out++] = c;
+            break;
+        case TELNET_STATE_IAC:
+            if (c == TELNET_IAC) {
+                data[out++] = c;
+                bridge->state = TELNET_STATE_DATA;
+            } else if (c >= TELNET_WILL) {
+                bridge->verb = c;
+                bridge->state = TELNET_STATE_OPTION;
+            } else if (c == TELNET_SB) {
+                bridge->state = TELNET_STATE_SB;
+            } else {
+                bridge->state = TELNET_STATE_DATA;
+            }
+            break;
+        case TELNET_STATE_OPTION:
+            telnet_answer(bridge, bridge->verb, c, reply, reply_len);
+            bridge->state = TELNET_STATE_DATA;
+            break;
+        case TELNET_STATE_SB:
+            if (c == TELNET_IAC)
+                bridge->state = TELNET_STATE_SB_IAC;
+            break;
+        case TELNET_STATE_SB_IAC:
+            bridge->state = c == TELNET_SE ? TELNET_STATE_DATA : TELNET_STATE_SB;
+            break;
+        }
+    }
+    return out;
+}
+
+static bool bridge_queue(struct ws_bridge *bridge, const uint8_t *data, size_t len)
+{
+    if (len > BRIDGE_TX_BUFFER - bridge->tx_len)
+        return false;
+    memcpy(bridge->tx + bridge->tx_len, data, len);
+    bridge->tx_len += len;
+    return true;
+}
+
+/* Write as much queued input as the socket takes without blocking.  Returns
+ * false once the session socket is unusable. */
+static bool bridge_flush(struct ws_bridge *bridge)
+{
+    while (bridge->tx_len > 0) {
+        int sent = send(bridge->tcp_fd, bridge->tx, bridge->tx_len, MSG_DONTWAIT);
+        if (sent < 0)
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        if (sent == 0)
+            return false;
+        bridge->tx_len -= (size_t) sent;
+        memmove(bridge->tx, bridge->tx + sent, bridge->tx_len);
+    }
+    return true;
+}
+
+/* Read session output for one bridge into @out; called with s_bridge_lock
+ * held.  The socket was reported readable, so recv() does not wait. */
+static void bridge_pump(struct ws_bridge *bridge, struct bridge_send *out, uint8_t *buf,
+                        uint8_t *reply)
+{
+    int received = recv(bridge->tcp_fd, buf, BRIDGE_FRAME_MAX, MSG_DONTWAIT);
+    if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return;
+    if (received <= 0) {
+        out->error = "{\"error\":\"session closed\"}";
+        return;
+    }
+
+    if (!bridge->admitted)
+        bridge->admitted = out->admit = true;
+
+    size_t len = (size_t) received;
+    size_t reply_len = 0;
+    if (bridge->telnet)
+        len = telnet_filter(bridge, buf, len, reply, &reply_len);
+    if (reply_len > 0 && (!bridge_queue(bridge, reply, reply_len) || !bridge_flush(bridge))) {
+        out->error = "{\"error\":\"session closed\"}";
+        return;
+    }
+    out->data = buf;
+    out->data_len = len;
+}
+
+static void bridge_report(struct ws_bridge *bridge, struct bridge_send *out, int64_t now)
+{
+    if (now - bridge->last_stats_us < BRIDGE_STATS_MS * 1000LL)
+        return;
+    if (bridge->to_serial == bridge->reported_to && bridge->from_serial == bridge->reported_from &&
+        bridge->dropped == bridge->reported_dropped)
+        return;
+
+    int len = snprintf(out->stats, sizeof(out->stats),
+                       "{\"to_serial\":%" PRIu32 ",\"from_serial\":%" PRIu32 ",\"dropped\":%" PRIu32 "}",
+                       bridge->to_serial, bridge->from_serial, bridge->dropped);
+    out->stats_len = (size_t) len;
+    bridge->reported_to = bridge->to_serial;
+    bridge->reported_from = bridge->from_serial;
+    bridge->reported_dropped = bridge->dropped;
+    bridge->last_stats_us = now;
+}
+
+/* Send the frames collected for one bridge; called without s_bridge_lock. */
+static bool bridge_send(const struct bridge_send *out)
+{
+    static const char connected[] = "{\"connected\":true}";
+    if (out->admit &&
+        ws_send_async(out->ws_fd, HTTPD_WS_TYPE_TEXT, connected, sizeof(connected) - 1) != ESP_OK)
+        return false;
+    if (out->data_len > 0 &&
+        ws_send_async(out->ws_fd, HTTPD_WS_TYPE_BINARY, out->data, out->data_len) != ESP_OK)
+        return false;
+    if (out->stats_len > 0 &&
+        ws_send_async(out->ws_fd, HTTPD_WS_TYPE_TEXT, out->stats, out->stats_len) != ESP_OK)
+        return false;
+    if (out->error)
+        ws_send_async(out->ws_fd, HTTPD_WS_TYPE_TEXT, out->error, strlen(out->error));
+    return true;
+}
+
+static void bridge_task(void *arg)
+{
+    (void) arg;
+    uint8_t *buf = malloc(BRIDGE_FRAME_MAX);
+    uint8_t *reply = malloc(BRIDGE_FRAME_MAX);
+    struct ser2net_active_session sessions[SER2NET_MAX_PORTS];
+
+    while (buf && reply) {
+        fd_set rfds;
+        fd_set wfds;
+        FD_ZERO(&rfds);
+        FD_ZERO(&wfds);
+        int max_fd = -1;
+        bool active = false;
+        bool admitting = false;
+
+        xSemaphoreTake(s_bridge_lock, portMAX_DELAY);
+        for (size_t i = 0; i < BRIDGE_MAX_CLIENTS; ++i) {
+            struct ws_bridge *bridge = &s_bridges[i];
+            if (bridge->ws_fd < 0 || bridge->busy)
+                continue;
+            if (httpd_ws_get_fd_info(s_server, bridge->ws_fd) != HTTPD_WS_CLIENT_WEBSOCKET) {
+                bridge_release(bridge);
+                continue;
+            }
+            active = true;
+            if (!bridge->admitted)
+                admitting = true;
+            /* Only read from the session while the browser can take data, so
+             * a slow tab backs up into TCP flow control instead of dropping
+             * serial output. */
+            if (socket_writable(bridge->ws_fd)) {
+                FD_SET(bridge->tcp_fd, &rfds);
+                if (bridge->tcp_fd > max_fd)
+                    max_fd = bridge->tcp_fd;
+            }
+            if (bridge->tx_len > 0) {
+                FD_SET(bridge->tcp_fd, &wfds);
+                if (bridge->tcp_fd > max_fd)
+                    max_fd = bridge->tcp_fd;
+            }
+        }
+        if (!active)
+            s_bridge_running = false;
+        xSemaphoreGive(s_bridge_lock);
+
+        if (!active)
+            break;
+
+        int ready = 0;
+        if (max_fd >= 0) {
+            struct timeval tv = { .tv_sec = 0, .tv_usec = BRIDGE_POLL_MS * 1000 };
+            ready = select(max_fd + 1, &rfds, &wfds, NULL, &tv);
+        } else {
+            vTaskDelay(pdMS_TO_TICKS(BRIDGE_POLL_MS));
+        }
+
+        size_t session_count = 0;
+        if (admitting)
+            session_count = ser2net_runtime_list_sessions(sessions, SER2NET_MAX_PORTS);
+
+        int64_t now = esp_timer_get_time();
+        for (size_t i = 0; i < BRIDGE_MAX_CLIENTS; ++i) {
+            struct ws_bridge *bridge = &s_bridges[i];
+            struct bridge_send out = { .ws_fd = -1 };
+
+            xSemaphoreTake(s_bridge_lock, portMAX_DELAY);
+            if (bridge->ws_fd >= 0 && !bridge->busy) {
+                if (bridge->broken) {
+                    out.error = "{\"error\":\"session closed\"}";
+                } else if (admitting && !bridge->admitted) {
+                    if (sessions_for_port(bridge->tcp_port, sessions, session_count) >
+                        bridge->sessions_before)
+                        bridge->admitted = out.admit = true;
+                    else if (now - bridge->opened_us > BRIDGE_ADMIT_TIMEOUT_MS * 1000LL)
+                        out.error = "{\"error\":\"no free session on this port\"}";
+                }
+                if (!out.error && ready > 0 && FD_ISSET(bridge->tcp_fd, &wfds) &&
+                    !bridge_flush(bridge))
+                    out.error = "{\"error\":\"session closed\"}";
+                if (!out.error && ready > 0 && FD_ISSET(bridge->tcp_fd, &rfds))
+                    bridge_pump(bridge, &out, buf, reply);
+                if (!out.error)
+                    bridge_report(bridge, &out, now);
+                if (out.admit || out.data_len > 0 || out.stats_len > 0 || out.error) {
+                    out.ws_fd = bridge->ws_fd;
+                    bridge->busy = true;
+                }
+            }
+            xSemaphoreGive(s_bridge_lock);
+
+            if (out.ws_fd < 0)
+                continue;
+            bool sent = bridge_send(&out);
+
+            xSemaphoreTake(s_bridge_lock, portMAX_DELAY);
+            bridge->busy = false;
+            if (!sent || out.error) {
+                httpd_sess_trigger_close(s_server, bridge->ws_fd);
+                bridge_release(bridge);
+            } else {
+                bridge->from_serial += out.data_len;
+                s_bridge_bytes_from_serial += out.data_len;
+            }
+            xSemaphoreGive(s_bridge_lock);
+        }
+    }
+
+    if (!buf || !reply) {
+        ESP_LOGE(TAG, "Bridge: out of memory");
+        xSemaphoreTake(s_bridge_lock, portMAX_DELAY);
+        for (size_t i = 0; i < BRIDGE_MAX_CLIENTS; ++i) {
+            if (s_bridges[i].ws_fd >= 0) {
+                httpd_sess_trigger_close(s_server, s_bridges[i].ws_fd);
+                bridge_release(&s_bridges[i]);
+            }
+        }
+        s_bridge_running = false;
+        xSemaphoreGive(s_bridge_lock);
+    }
+    free(buf);
+    free(reply);
+    vTaskDelete(NULL);
+}
+
+static int bridge_connect(uint16_t tcp_port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (fd < 0)
+        return -1;
+
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(tcp_port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK)
+    };
+    if (connect(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static esp_err_t bridge_open(httpd_req_t *req)
+{
+    static const char base[] = "/ws/ports/";
+    char *end = NULL;
+    long tcp_port = strtol(req->uri + sizeof(base) - 1, &end, 10);
+    if (!end || (*end && *end != '?') || tcp_port <= 0 || tcp_port > 65535)
+        return ws_send_error(req, "invalid port");
+
+    struct ser2net_esp32_serial_port_cfg ports[SER2NET_MAX_PORTS];
+    size_t count = ser2net_runtime_copy_ports(ports, SER2NET_MAX_PORTS);
+    const struct ser2net_esp32_serial_port_cfg *port =
+        find_port_by_tcp((uint16_t) tcp_port, ports, count);
+    if (!port)
+        return ws_send_error(req, "port not found");
+    if (!port->enabled)
+        return ws_send_error(req, "port disabled");
+
+    const char *error = NULL;
+    int ws_fd = httpd_req_to_sockfd(req);
+    xSemaphoreTake(s_bridge_lock, portMAX_DELAY);
+    struct ws_bridge *slot = NULL;
+    for (size_t i = 0; i < BRIDGE_MAX_CLIENTS && !slot; ++i) {
+        if (s_bridges[i].ws_fd < 0)
+            slot = &s_bridges[i];
+    }
+    if (slot)
+        *slot = (struct ws_bridge) { .ws_fd = ws_fd, .tcp_fd = -1, .busy = true };
+    xSemaphoreGive(s_bridge_lock);
+    if (!slot)
+        return ws_send_error(req, "too many terminal sessions");
+
+    /* The slot is ours; only now take a session from the port. */
+    struct ser2net_active_session sessions[SER2NET_MAX_PORTS];
+    size_t session_count = ser2net_runtime_list_sessions(sessions, SER2NET_MAX_PORTS);
+    int sessions_before = sessions_for_port((uint16_t) tcp_port, sessions, session_count);
+
+    int tcp_fd = -1;
+    uint8_t *tx = malloc(BRIDGE_TX_BUFFER);
+    if (!tx)
+        error = "out of memory";
+    else if ((tcp_fd = bridge_connect((uint16_t) tcp_port)) < 0)
+        error = "port listener unreachable";
+
+    xSemaphoreTake(s_bridge_lock, portMAX_DELAY);
+    if (error) {
+        free(tx);
+        slot->ws_fd = -1;
+        slot->busy = false;
+    } else {
+        *slot = (struct ws_bridge) {
+            .ws_fd = ws_fd,
+            .tcp_fd = tcp_fd,
+            .tcp_port = (uint16_t) tcp_port,
+            .sessions_before = sessions_before,
+            .opened_us = esp_timer_get_time(),
+            .tx = tx,
+            .telnet = port->mode == SER2NET_PORT_MODE_TELNET,
+            .state = TELNET_STATE_DATA,
+            .last_stats_us = esp_timer_get_time()
+        };
+        s_bridge_sessions++;
+        if (!s_bridge_running) {
+            s_bridge_running = true;
+            if (xTaskCreate(bridge_task, "ws_bridge", BRIDGE_TASK_STACK,
+                            NULL, tskIDLE_PRIORITY + 4, NULL) != pdPASS) {
+                s_bridge_running = false;
+                bridge_release(slot);
+                error = "unable to start bridge";
+            }
+        }
+    }
+    xSemaphoreGive(s_bridge_lock);
+
+    if (error)
+        return ws_send_error(req, error);
+    return ESP_OK;
+}
+
+static esp_err_t ws_port_handler(httpd_req_t *req)
+{
+    if (req->method == HTTP_GET)
+        return bridge_open(req);
+
+    httpd_ws_frame_t frame = {0};
+    esp_err_t err = httpd_ws_recv_frame(req, &frame, 0);
+    if (err != ESP_OK || frame.len == 0)
+        return err;
+    if (frame.len > BRIDGE_FRAME_MAX)
+        return ESP_FAIL;
+    frame.payload = s_bridge_in;
+    err = httpd_ws_recv_frame(req, &frame, frame.len);
+    if (err != ESP_OK)
+        return err;
+    if (frame.type != HTTPD_WS_TYPE_BINARY && frame.type != HTTPD_WS_TYPE_TEXT)
+        return ESP_OK;
+
+    int fd = httpd_req_to_sockfd(req);
+    esp_err_t res = ESP_FAIL;
+    xSemaphoreTake(s_bridge_lock, portMAX_DELAY);
+    for (size_t i = 0; i < BRIDGE_MAX_CLIENTS; ++i) {
+        struct ws_bridge *bridge = &s_bridges[i];
+        if (bridge->ws_fd != fd)
+            continue;
+
+        const uint8_t *data = s_bridge_in;
+        size_t len = frame.len;
+        if (bridge->telnet) {
+            size_t out = 0;
+            for (size_t j = 0; j < frame.len; ++j) {
+                s_bridge_out[out++] = s_bridge_in[j];
+                if (s_bridge_in[j] == TELNET_IAC)
+                    s_bridge_out[out++] = TELNET_IAC;
+            }
+            data = s_bridge_out;
+            len = out;
+        }
+        res = ESP_OK;
+        if (bridge->broken)
+            break;              /* the bridge task closes it */
+        if (!bridge_queue(bridge, data, len)) {
+            bridge->dropped += frame.len;
+        } else if (bridge_flush(bridge)) {
+            bridge->to_serial += frame.len;
+            s_bridge_bytes_to_serial += frame.len;
+        } else {
+            /* The bridge task may be sending to this browser right now, so
+             * leave the slot to it. */
+            bridge->broken = true;
+        }
+        break;
+    }
+    xSemaphoreGive(s_bridge_lock);
+    return res;
+}
+#endif /* WS_BRIDGE_ENABLED */
+
+/*
+ * Handlers that can block for a while (Wi-Fi reconfiguration, runtime port
+ * changes and the NVS writes they trigger) are detached from the httpd task
+ * and run on a small worker pool, so reads and static assets are not stuck
+ * behind them.  When the queue is full the request is refused with 503.
+ *
+ * net_manager keeps its state in unlocked statics that used to be touched by
+ * the httpd task alone, so Wi-Fi jobs run one at a time under s_wifi_job_lock.
+ * PATCH batches are serialised under s_batch_job_lock so that each one owns
+ * the config_store batch it opens and "persisted" means what it says.
+ */
+struct async_job {
+    httpd_req_t *req;
+    esp_err_t (*handler)(httpd_req_t *req);
+    SemaphoreHandle_t lock; /* optional, held while the handler runs */
+};
+
+static QueueHandle_t s_async_queue;
+static SemaphoreHandle_t s_wifi_job_lock;
+static SemaphoreHandle_t s_batch_job_lock;
+/* Jobs accepted but not yet completed, queued or running; stop waits on it. */
+static uint32_t s_async_pending;
+
+static void async_worker_task(void *arg)
+{
+    (void) arg;
+    struct async_job job;
+    for (;;) {
+        if (xQueueReceive(s_async_queue, &job, portMAX_DELAY) != pdTRUE)
+            continue;
+        if (job.lock)
+            xSemaphoreTake(job.lock, portMAX_DELAY);
+        job.handler(job.req);
+        if (job.lock)
+            xSemaphoreGive(job.lock);
+        httpd_req_async_handler_complete(job.req);
+        __atomic_sub_fetch(&s_async_pending, 1, __ATOMIC_RELEASE);
+    }
+}
+
+static esp_err_t async_dispatch(httpd_req_t *req, esp_err_t (*handler)(httpd_req_t *req),
+                               SemaphoreHandle_t lock)
+{
+    /* Only the httpd task enqueues, so free space cannot shrink between this
+     * check and xQueueSend(). */
+    if (uxQueueSpacesAvailable(s_async_queue) == 0) {
+        httpd_resp_set_hdr(req, "Retry-After", "1");
+        return send_json_error(req, "503 Service Unavailable", "server busy");
+    }
+
+    struct async_job job = { .handler = handler, .lock = lock };
+    if (httpd_req_async_handler_begin(req, &job.req) != ESP_OK)
+        return httpd_resp_send_500(req);
+
+    __atomic_add_fetch(&s_async_pending, 1, __ATOMIC_RELAXED);
+    if (xQueueSend(s_async_queue, &job, 0) != pdTRUE) {
+        __atomic_sub_fetch(&s_async_pending, 1, __ATOMIC_RELEASE);
+        httpd_req_async_handler_complete(job.req);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t wifi_post_async(httpd_req_t *req)
+{
+    return async_dispatch(req, wifi_post_handler, s_wifi_job_lock);
+}
+
+static esp_err_t wifi_delete_async(httpd_req_t *req)
+{
+    return async_dispatch(req, wifi_delete_handler, s_wifi_job_lock);
+}
+
+static esp_err_t ports_post_async(httpd_req_t *req)
+{
+    return async_dispatch(req, ports_post_handler, NULL);
+}
+
+static esp_err_t ports_patch_async(httpd_req_t *req)
+{
+    return async_dispatch(req, ports_patch_handler, s_batch_job_lock);
+}
+
+static esp_err_t ports_action_async(httpd_req_t *req)
+{
+    return async_dispatch(req, ports_action_handler, NULL);
+}
+
+static esp_err_t ports_delete_async(httpd_req_t *req)
+{
+    return async_dispatch(req, ports_delete_handler, NULL);
+}
+
 bool web_server_start(void)
 {
     if (s_server) {
@@ -1237,11 +2812,68 @@ bool web_server_start(void)
         return true;
     }
 
+    if (!s_events_lock) {
+        s_events_lock = xSemaphoreCreateMutex();
+        if (!s_events_lock)
+            return false;
+    }
+
+    if (!s_async_queue) {
+        s_wifi_job_lock = xSemaphoreCreateMutex();
+        s_batch_job_lock = xSemaphoreCreateMutex();
+        s_async_queue = xQueueCreate(ASYNC_QUEUE_LEN, sizeof(struct async_job));
+        if (!s_wifi_job_lock || !s_batch_job_lock || !s_async_queue)
+            return false;
+        for (int i = 0; i < ASYNC_WORKERS; ++i) {
+            if (xTaskCreate(async_worker_task, "http_worker", ASYNC_WORKER_STACK,
+                            NULL, tskIDLE_PRIORITY + 5, NULL) != pdPASS) {
+                ESP_LOGE(TAG, "Failed to start HTTP worker %d", i);
+                return false;
+            }
+        }
+    }
+
+#if WS_BRIDGE_ENABLED
+    if (!s_bridge_lock) {
+        s_bridge_lock = xSemaphoreCreateMutex();
+        if (!s_bridge_lock)
+            return false;
+        for (size_t i = 0; i < BRIDGE_MAX_CLIENTS; ++i)
+            s_bridges[i].ws_fd = -1;
+    }
+#endif
+
+#if WS_MONITOR_ENABLED
+    if (!s_monitor_lock) {
+        s_monitor_lock = xSemaphoreCreateMutex();
+        if (!s_monitor_lock)
+            return false;
+        for (size_t i = 0; i < MONITOR_MAX_SUBSCRIBERS; ++i)
+            s_monitor_subs[i].fd = -1;
+    }
+#endif
+
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.server_port = 80;
     config.uri_match_fn = httpd_uri_match_wildcard;
-    if (config.max_uri_handlers < 16)
-        config.max_uri_handlers = 16;
+    if (config.max_uri_handlers < 20)
+        config.max_uri_handlers = 20;
+
+    /* Event streams and WebSockets hold a session for as long as they are
+     * open; size the session table for all of them plus some room for
+     * ordinary requests, and let httpd recycle the least recently used
+     * session if it still fills up. */
+    int sessions = HTTP_REQUEST_SOCKETS + EVENTS_MAX_CLIENTS;
+#if WS_MONITOR_ENABLED
+    sessions += MONITOR_MAX_SUBSCRIBERS;
+#endif
+#if WS_BRIDGE_ENABLED
+    sessions += BRIDGE_MAX_CLIENTS;
+#endif
+    if (sessions > CONFIG_LWIP_MAX_SOCKETS - HTTPD_INTERNAL_SOCKETS)
+        sessions = CONFIG_LWIP_MAX_SOCKETS - HTTPD_INTERNAL_SOCKETS;
+    config.max_open_sockets = sessions;
+    config.lru_purge_enable = true;
 
     ESP_LOGI(TAG, "Starting HTTP server on port %d", config.server_port);
     esp_err_t err = httpd_start(&s_server, &config);
@@ -1251,27 +2883,33 @@ bool web_server_start(void)
         return false;
     }
 
+    __atomic_add_fetch(&s_config_generation, esp_random(), __ATOMIC_RELAXED);
+
+    web_asset_init_etag(&s_web_index);
+    web_asset_init_etag(&s_web_style);
+    web_asset_init_etag(&s_web_script);
+
     httpd_uri_t ui_root = {
         .uri = "/",
         .method = HTTP_GET,
-        .handler = web_index_handler,
-        .user_ctx = NULL
+        .handler = web_asset_handler,
+        .user_ctx = &s_web_index
     };
     httpd_register_uri_handler(s_server, &ui_root);
 
     httpd_uri_t ui_style = {
         .uri = "/static/app.css",
         .method = HTTP_GET,
-        .handler = web_style_handler,
-        .user_ctx = NULL
+        .handler = web_asset_handler,
+        .user_ctx = &s_web_style
     };
     httpd_register_uri_handler(s_server, &ui_style);
 
     httpd_uri_t ui_script = {
         .uri = "/static/app.js",
         .method = HTTP_GET,
-        .handler = web_script_handler,
-        .user_ctx = NULL
+        .handler = web_asset_handler,
+        .user_ctx = &s_web_script
     };
     httpd_register_uri_handler(s_server, &ui_script);
 
@@ -1291,6 +2929,22 @@ bool web_server_start(void)
     };
     httpd_register_uri_handler(s_server, &uri_system);
 
+    httpd_uri_t uri_events = {
+        .uri = "/api/events",
+        .method = HTTP_GET,
+        .handler = events_handler,
+        .user_ctx = NULL
+    };
+    httpd_register_uri_handler(s_server, &uri_events);
+
+    httpd_uri_t uri_metrics = {
+        .uri = "/api/metrics",
+        .method = HTTP_GET,
+        .handler = metrics_get_handler,
+        .user_ctx = NULL
+    };
+    httpd_register_uri_handler(s_server, &uri_metrics);
+
     httpd_uri_t uri_wifi_get = {
         .uri = "/api/wifi",
         .method = HTTP_GET,
@@ -1302,7 +2956,7 @@ bool web_server_start(void)
     httpd_uri_t uri_wifi_post = {
         .uri = "/api/wifi",
         .method = HTTP_POST,
-        .handler = wifi_post_handler,
+        .handler = wifi_post_async,
         .user_ctx = NULL
     };
     httpd_register_uri_handler(s_server, &uri_wifi_post);
@@ -1310,7 +2964,7 @@ bool web_server_start(void)
     httpd_uri_t uri_wifi_delete = {
         .uri = "/api/wifi",
         .method = HTTP_DELETE,
-        .handler = wifi_delete_handler,
+        .handler = wifi_delete_async,
         .user_ctx = NULL
     };
     httpd_register_uri_handler(s_server, &uri_wifi_delete);
@@ -1326,15 +2980,23 @@ bool web_server_start(void)
     httpd_uri_t uri_ports_post = {
         .uri = "/api/ports",
         .method = HTTP_POST,
-        .handler = ports_post_handler,
+        .handler = ports_post_async,
         .user_ctx = NULL
     };
     httpd_register_uri_handler(s_server, &uri_ports_post);
 
+    httpd_uri_t uri_ports_patch = {
+        .uri = "/api/ports",
+        .method = HTTP_PATCH,
+        .handler = ports_patch_async,
+        .user_ctx = NULL
+    };
+    httpd_register_uri_handler(s_server, &uri_ports_patch);
+
     httpd_uri_t uri_ports_action = {
         .uri = "/api/ports/*",
         .method = HTTP_POST,
-        .handler = ports_action_handler,
+        .handler = ports_action_async,
         .user_ctx = NULL
     };
     httpd_register_uri_handler(s_server, &uri_ports_action);
@@ -1342,11 +3004,33 @@ bool web_server_start(void)
     httpd_uri_t uri_ports_delete = {
         .uri = "/api/ports/*",
         .method = HTTP_DELETE,
-        .handler = ports_delete_handler,
+        .handler = ports_delete_async,
         .user_ctx = NULL
     };
     httpd_register_uri_handler(s_server, &uri_ports_delete);
 
+#if WS_MONITOR_ENABLED
+    httpd_uri_t uri_ws_monitor = {
+        .uri = "/ws/monitor",
+        .method = HTTP_GET,
+        .handler = ws_monitor_handler,
+        .user_ctx = NULL,
+        .is_websocket = true
+    };
+    httpd_register_uri_handler(s_server, &uri_ws_monitor);
+#endif
+
+#if WS_BRIDGE_ENABLED
+    httpd_uri_t uri_ws_port = {
+        .uri = "/ws/ports/*",
+        .method = HTTP_GET,
+        .handler = ws_port_handler,
+        .user_ctx = NULL,
+        .is_websocket = true
+    };
+    httpd_register_uri_handler(s_server, &uri_ws_port);
+#endif
+
     return true;
 }
 
@@ -1356,6 +3040,38 @@ void web_server_stop(void)
         return;
 
     ESP_LOGI(TAG, "Stopping HTTP server");
+
+    /* Release detached event streams while their sessions still exist; the
+     * events task exits once it finds no clients left.  A stream that is
+     * being written to is released once its send returns. */
+    for (bool busy = true; busy; ) {
+        busy = false;
+        xSemaphoreTake(s_events_lock, portMAX_DELAY);
+        for (size_t i = 0; i < EVENTS_MAX_CLIENTS; ++i) {
+            struct events_client *client = &s_events_clients[i];
+            if (client->busy) {
+                busy = true;
+            } else if (client->req) {
+                httpd_req_async_handler_complete(client->req);
+                client->req = NULL;
+            }
+        }
+        xSemaphoreGive(s_events_lock);
+        if (busy)
+            vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    /* Requests still waiting for a worker belong to this server instance;
+     * drop them, then let the ones already running finish before the server
+     * and its sessions go away. */
+    struct async_job job;
+    while (xQueueReceive(s_async_queue, &job, 0) == pdTRUE) {
+        httpd_req_async_handler_complete(job.req);
+        __atomic_sub_fetch(&s_async_pending, 1, __ATOMIC_RELEASE);
+    }
+    while (__atomic_load_n(&s_async_pending, __ATOMIC_ACQUIRE) > 0)
+        vTaskDelay(pdMS_TO_TICKS(10));
+
     httpd_stop(s_server);
     s_server = NULL;
 }
@@ -0,0 +1,369 @@
+const statusElements={ssid:document.getElementById('sta-ssid'),ip:document.getElementById('sta-ip'),state:document.getElementById('sta-state'),ap:document.getElementById('ap-state'),apTimeout:document.getElementById('ap-timeout')};
+const messageBox=document.getElementById('message');
+const form=document.getElementById('wifi-form');
+const toggleApBtn=document.getElementById('toggle-ap');
+const forgetBtn=document.getElementById('forget-wifi');
+const portsTableBody=document.getElementById('ports-table-body');
+
+function showMessage(text,type='info'){
+  messageBox.textContent=text;
+  messageBox.classList.remove('error','success');
+  if(type==='error') messageBox.classList.add('error');
+  if(type==='success') messageBox.classList.add('success');
+  messageBox.hidden=false;
+}
+
+function hideMessage(){messageBox.hidden=true;}
+
+function describeState(connected,configured){
+  if(!configured) return 'Not configured';
+  return connected?'Connected':'Disconnected';
+}
+
+function describeAp(active,forcedDisable,remaining){
+  if(forcedDisable) return 'Disabled (forced)';
+  if(!active) return 'Standby';
+  if(remaining>0) return `Active (${remaining}s left)`;
+  return 'Active';
+}
+
+async function fetchWifiStatus(){
+  const res=await fetch('/api/wifi',{cache:'no-store'});
+  if(!res.ok) throw new Error('Unable to retrieve Wi-Fi status');
+  return res.json();
+}
+
+async function fetchSystem(){
+  const res=await fetch('/api/system',{cache:'no-store'});
+  if(!res.ok) throw new Error('Unable to retrieve system status');
+  return res.json();
+}
+
+async function fetchPorts(){
+  const res=await fetch('/api/ports',{cache:'no-cache'});
+  if(!res.ok) throw new Error('Unable to retrieve port list');
+  return res.json();
+}
+
+function formatFrame(port){
+  return `${port.data_bits}/${port.parity}/${port.stop_bits}`;
+}
+
+function renderPorts(ports){
+  if(!Array.isArray(ports)){return;}
+  portsTableBody.innerHTML='';
+  if(ports.length===0){
+    const row=document.createElement('tr');
+    const cell=document.createElement('td');
+    cell.colSpan=8;
+    cell.textContent='No serial ports configured';
+    row.appendChild(cell);
+    portsTableBody.appendChild(row);
+    return;
+  }
+  ports.forEach(port=>{
+    const row=document.createElement('tr');
+    const cells=[
+      port.tcp_port,
+      `UART${port.uart}`,
+      port.mode,
+      port.enabled?'Yes':'No',
+      port.baud,
+      formatFrame(port),
+      port.flow_control===0?'None':'RTS/CTS',
+      port.active_sessions
+    ];
+    cells.forEach(value=>{
+      const cell=document.createElement('td');
+      cell.textContent=value;
+      row.appendChild(cell);
+    });
+    portsTableBody.appendChild(row);
+  });
+}
+
+function applyWifi(data){
+  statusElements.ssid.textContent=data.sta_ssid||'–';
+  statusElements.ip.textContent=data.sta_ip||'–';
+  statusElements.state.textContent=describeState(data.sta_connected,data.sta_configured);
+  statusElements.ap.textContent=describeAp(data.softap_active,data.softap_force_disabled,data.softap_remaining_seconds);
+  statusElements.apTimeout.textContent=data.softap_remaining_seconds?`${data.softap_remaining_seconds}s`:'–';
+  toggleApBtn.textContent=data.softap_force_disabled?'Enable SoftAP':'Disable SoftAP';
+}
+
+function applySystem(data){
+  const uptime=document.getElementById('sta-state');
+  const seconds=Math.floor(data.uptime_ms/1000);
+  uptime.dataset.uptime=`Uptime: ${seconds}s`;
+}
+
+function applyPorts(ports){
+  renderPorts(ports);
+  fillPortSelect(monitorPort,ports);
+  fillPortSelect(termPort,ports);
+}
+
+async function refreshStatus(){
+  try{
+    const [wifi,sys,ports]=await Promise.allSettled([fetchWifiStatus(),fetchSystem(),fetchPorts()]);
+    if(wifi.status==='fulfilled') applyWifi(wifi.value);
+    if(sys.status==='fulfilled') applySystem(sys.value);
+    if(ports.status==='fulfilled') applyPorts(ports.value);
+  }catch(err){
+    console.error(err);
+    showMessage(err.message,'error');
+  }
+}
+
+form.addEventListener('submit',async(e)=>{
+  e.preventDefault();
+  hideMessage();
+  const ssid=document.getElementById('ssid').value.trim();
+  const password=document.getElementById('password').value;
+  const keepAp=document.getElementById('keep-ap').checked;
+  if(!ssid){
+    showMessage('SSID must not be empty','error');
+    return;
+  }
+  try{
+    const payload={ssid,password,softap_enabled:keepAp};
+    const res=await fetch('/api/wifi',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify(payload)});
+    if(!res.ok){
+      const text=await res.text();
+      throw new Error(text||'Failed to apply credentials');
+    }
+    showMessage('Credentials saved. Connecting…','success');
+    form.reset();
+    document.getElementById('keep-ap').checked=keepAp;
+    await refreshStatus();
+  }catch(err){
+    console.error(err);
+    showMessage(err.message,'error');
+  }
+});
+
+toggleApBtn.addEventListener('click',async()=>{
+  hideMessage();
+  try{
+    const current=await fetchWifiStatus();
+    const desired=current.softap_force_disabled;
+    const res=await fetch('/api/wifi',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify({softap_enabled:desired})});
+    if(!res.ok){
+      const text=await res.text();
+      throw new Error(text||'Failed to toggle SoftAP');
+    }
+    showMessage(`SoftAP ${desired?'enabled':'disabled'}.`,'success');
+    await refreshStatus();
+  }catch(err){
+    console.error(err);
+    showMessage(err.message,'error');
+  }
+});
+
+forgetBtn.addEventListener('click',async()=>{
+  hideMessage();
+  if(!confirm('Forget stored Wi-Fi credentials and return to provisioning mode?')) return;
+  try{
+    const res=await fetch('/api/wifi',{method:'DELETE'});
+    if(!res.ok){
+      const text=await res.text();
+      throw new Error(text||'Failed to clear credentials');
+    }
+    showMessage('Credentials cleared. Device is now in provisioning mode.','success');
+    await refreshStatus();
+  }catch(err){
+    console.error(err);
+    showMessage(err.message,'error');
+  }
+});
+
+const monitorPort=document.getElementById('monitor-port');
+const monitorDir=document.getElementById('monitor-dir');
+const monitorToggle=document.getElementById('monitor-toggle');
+const monitorStatus=document.getElementById('monitor-status');
+const monitorOutput=document.getElementById('monitor-output');
+const MONITOR_KEEP=16384;
+let monitorSocket=null;
+let monitorDecoder=null;
+
+function fillPortSelect(select,ports){
+  const current=select.value;
+  select.innerHTML='';
+  ports.forEach(port=>{
+    const opt=document.createElement('option');
+    opt.value=port.tcp_port;
+    opt.textContent=`TCP ${port.tcp_port} (UART${port.uart})`;
+    select.appendChild(opt);
+  });
+  if(current) select.value=current;
+}
+
+function appendMonitor(text){
+  let data=monitorOutput.textContent+text;
+  if(data.length>MONITOR_KEEP) data=data.slice(-MONITOR_KEEP);
+  monitorOutput.textContent=data;
+  monitorOutput.scrollTop=monitorOutput.scrollHeight;
+}
+
+function stopMonitor(){
+  if(monitorSocket){monitorSocket.onclose=null;monitorSocket.close();}
+  monitorSocket=null;
+  monitorToggle.textContent='Start';
+}
+
+function startMonitor(){
+  if(!monitorPort.value){showMessage('No serial port to monitor','error');return;}
+  const url=`ws://${location.host}/ws/monitor?port=${monitorPort.value}&dir=${monitorDir.value}`;
+  monitorDecoder=new TextDecoder('utf-8');
+  monitorOutput.textContent='';
+  monitorStatus.textContent='';
+  monitorSocket=new WebSocket(url);
+  monitorSocket.binaryType='arraybuffer';
+  monitorSocket.onmessage=(ev)=>{
+    if(typeof ev.data==='string'){
+      const info=JSON.parse(ev.data);
+      if(info.error) monitorStatus.textContent=info.error;
+      if(info.dropped!==undefined) monitorStatus.textContent=`${info.dropped} bytes dropped`;
+      return;
+    }
+    appendMonitor(monitorDecoder.decode(new Uint8Array(ev.data),{stream:true}));
+  };
+  monitorSocket.onclose=()=>{
+    if(!monitorStatus.textContent) monitorStatus.textContent='Disconnected';
+    stopMonitor();
+  };
+  monitorToggle.textContent='Stop';
+}
+
+monitorToggle.addEventListener('click',()=>{
+  if(monitorSocket) stopMonitor(); else startMonitor();
+});
+
+const termPort=document.getElementById('term-port');
+const termToggle=document.getElementById('term-toggle');
+const termStatus=document.getElementById('term-status');
+const termOutput=document.getElementById('term-output');
+const termEncoder=new TextEncoder();
+const TERM_FRAME=512;
+const TERM_KEYS={Enter:'\r',Backspace:'\x7f',Tab:'\t',Escape:'\x1b',
+  ArrowUp:'\x1b[A',ArrowDown:'\x1b[B',ArrowRight:'\x1b[C',ArrowLeft:'\x1b[D',
+  Home:'\x1b[H',End:'\x1b[F',Delete:'\x1b[3~'};
+let termSocket=null;
+let termDecoder=null;
+let termLast=null;
+let termError=false;
+
+function appendTerminal(text){
+  let data=termOutput.textContent+text;
+  if(data.length>MONITOR_KEEP) data=data.slice(-MONITOR_KEEP);
+  termOutput.textContent=data;
+  termOutput.scrollTop=termOutput.scrollHeight;
+}
+
+// The bridge refuses frames over 512 bytes, so split big pastes.
+function termSend(bytes){
+  if(!termSocket||termSocket.readyState!==WebSocket.OPEN) return;
+  for(let i=0;i<bytes.length;i+=TERM_FRAME) termSocket.send(bytes.subarray(i,i+TERM_FRAME));
+}
+
+// The bridge reports its byte counters about once a second; show them with
+// the rate since the previous report.
+function showTerminalStats(info){
+  const now=performance.now();
+  let text=`TX ${info.to_serial} B, RX ${info.from_serial} B`;
+  if(termLast){
+    const secs=(now-termLast.time)/1000;
+    const tx=(info.to_serial-termLast.to_serial)/secs;
+    const rx=(info.from_serial-termLast.from_serial)/secs;
+    text+=` (${tx.toFixed(0)} / ${rx.toFixed(0)} B/s)`;
+  }
+  if(info.dropped) text+=`, ${info.dropped} B dropped`;
+  termLast={time:now,to_serial:info.to_serial,from_serial:info.from_serial};
+  termStatus.textContent=text;
+}
+
+function stopTerminal(){
+  if(termSocket){termSocket.onclose=null;termSocket.close();}
+  termSocket=null;
+  termToggle.textContent='Connect';
+}
+
+function startTerminal(){
+  if(!termPort.value){showMessage('No serial port to open','error');return;}
+  termDecoder=new TextDecoder('utf-8');
+  termLast=null;
+  termError=false;
+  termOutput.textContent='';
+  termStatus.textContent='Connecting…';
+  termSocket=new WebSocket(`ws://${location.host}/ws/ports/${termPort.value}`);
+  termSocket.binaryType='arraybuffer';
+  termSocket.onopen=()=>{termStatus.textContent='Waiting for a session…';termOutput.focus();};
+  termSocket.onmessage=(ev)=>{
+    if(typeof ev.data==='string'){
+      const info=JSON.parse(ev.data);
+      if(info.error){termError=true;termStatus.textContent=info.error;}
+      if(info.connected) termStatus.textContent='Connected';
+      if(info.to_serial!==undefined) showTerminalStats(info);
+      return;
+    }
+    appendTerminal(termDecoder.decode(new Uint8Array(ev.data),{stream:true}));
+  };
+  termSocket.onclose=()=>{
+    if(!termError) termStatus.textContent='Disconnected';
+    stopTerminal();
+  };
+  termToggle.textContent='Disconnect';
+}
+
+termToggle.addEventListener('click',()=>{
+  if(termSocket) stopTerminal(); else startTerminal();
+});
+
+termOutput.addEventListener('keydown',(ev)=>{
+  if(!termSocket||ev.metaKey) return;
+  let seq=null;
+  if(ev.ctrlKey&&ev.key.length===1){
+    const code=ev.key.toUpperCase().charCodeAt(0);
+    if(code>=64&&code<96) seq=String.fromCharCode(code-64);
+  }else if(TERM_KEYS[ev.key]){
+    seq=TERM_KEYS[ev.key];
+  }else if(ev.key.length===1&&!ev.altKey){
+    seq=ev.key;
+  }
+  if(seq===null) return;
+  ev.preventDefault();
+  termSend(termEncoder.encode(seq));
+});
+
+termOutput.addEventListener('paste',(ev)=>{
+  if(!termSocket) return;
+  ev.preventDefault();
+  termSend(termEncoder.encode(ev.clipboardData.getData('text').replace(/\r?\n/g,'\r')));
+});
+
+let pollTimer=null;
+
+function startPolling(){
+  if(pollTimer) return;
+  refreshStatus();
+  pollTimer=window.setInterval(refreshStatus,5000);
+}
+
+function stopPolling(){
+  if(pollTimer) window.clearInterval(pollTimer);
+  pollTimer=null;
+}
+
+// /api/events pushes each resource when it changes; poll only while the
+// stream is down (reconnecting, refused, or no EventSource support).
+function startEvents(){
+  if(!window.EventSource){startPolling();return;}
+  const source=new EventSource('/api/events');
+  source.addEventListener('wifi',ev=>applyWifi(JSON.parse(ev.data)));
+  source.addEventListener('system',ev=>applySystem(JSON.parse(ev.data)));
+  source.addEventListener('ports',ev=>applyPorts(JSON.parse(ev.data)));
+  source.onopen=stopPolling;
+  source.onerror=startPolling;
+}
+
+document.addEventListener('DOMContentLoaded',startEvents);
@@ -74,6 +74,17 @@ static void persist_runtime_snapshot(void *ctx)
     if (persist && !config_store_save_control(persist->control_port, persist->control_backlog)) {
         ESP_LOGW(TAG, "Failed to persist control configuration");
     }
+    web_server_notify_config_changed();
+}
+#endif
+
+#if !(ENABLE_JSON_CONFIG && ENABLE_DYNAMIC_SESSIONS)
+/* Nothing to persist, but the web server still has to drop its cached ETag
+ * when the control port changes a port at runtime. */
+static void notify_config_changed(void *ctx)
+{
+    (void) ctx;
+    web_server_notify_config_changed();
 }
 #endif
 
@@ -260,6 +271,8 @@ void app_main(void)
 
     app_cfg.runtime_cfg.config_changed_cb = persist_runtime_snapshot;
     app_cfg.runtime_cfg.config_changed_ctx = &s_persist_ctx;
+#else
+    app_cfg.runtime_cfg.config_changed_cb = notify_config_changed;
 #endif
 
     if (ser2net_start(&app_cfg) != pdPASS) {
@@ -267,6 +280,9 @@ void app_main(void)
         goto cleanup;
     }
 
+    web_server_set_control_port(app_cfg.runtime_cfg.control_enabled ?
+                                app_cfg.runtime_cfg.control_ctx.tcp_port : 0);
+
 #if ENABLE_DYNAMIC_SESSIONS
     persist_runtime_snapshot(&s_persist_ctx);
 #endif
@@ -296,10 +312,15 @@ void app_main(void)
     app_cfg.runtime_cfg.control_enabled = false;
 #endif
 
+    app_cfg.runtime_cfg.config_changed_cb = notify_config_changed;
+
     if (ser2net_start(&app_cfg) != pdPASS) {
         ESP_LOGE(TAG, "ser2net_start() failed");
         goto cleanup;
     }
+
+    web_server_set_control_port(app_cfg.runtime_cfg.control_enabled ?
+                                app_cfg.runtime_cfg.control_ctx.tcp_port : 0);
 #endif /* ENABLE_JSON_CONFIG */
 
     while (true) {
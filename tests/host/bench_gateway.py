@@ -0,0 +1,473 @@
+"""Benchmarks for the ESP32 RFC2217 gateway data path.
+
+Streams a pseudo-random payload through one or more gateway ports and reads
+it back, so every port under test needs a TX<->RX loopback on its UART.  The
+script reports sustained bytes/sec and round-trip latency per chunk (TCP ->
+UART -> TCP) for each port plus an aggregate line, which makes it easy to
+compare firmware builds before rolling them out.
+
+Sending and receiving run on separate threads, so both directions of a
+session carry bulk traffic at the same time.  Each direction gets its own
+rate: TX is the pace at which the gateway accepts data, RX the pace at which
+it comes back, both timed over the last three quarters of the transfer so
+the initial burst into the socket buffers does not count.  `--baud` adds both
+as a share of the UART's 8N1 byte rate, and `--window 0` removes the
+in-flight cap so the sender only waits for the gateway.  Comparing `--window` equal to
+`--chunk` (stop-and-wait) with a large window shows how much the session
+gains from having data in flight.
+
+Telnet ports are supported: the payload never contains IAC (0xFF) and any
+negotiation sent by the gateway is stripped from the receive stream.
+
+The `connect` command measures connect-to-accept latency instead: how long
+it takes from a client's connect() until the gateway's session starts talking
+Telnet.  Run it across all listeners (8+ dynamic ports) to see how accept
+latency scales with the number of ports.  With `--first-byte` it times the
+echo of a probe byte instead (connect-to-first-byte), which adds the UART
+bring-up of a new session and works on raw ports too.
+
+The `http` command times the REST endpoints the dashboard polls, so changes
+to the web server's serialisation can be compared build against build.  With
+`--conditional` it replays each response's ETag like a browser does and
+counts the `304 Not Modified` answers.  `--during-writes <tcp>` keeps
+re-posting that port's current mode in the background, to check that reads
+stay fast while mutations are being processed.
+
+Usage:
+    SER2NET_ESP_IP=192.168.x.y python tests/host/bench_gateway.py \
+        throughput --ports 4000,4001 --bytes 65536
+    SER2NET_ESP_IP=192.168.x.y python tests/host/bench_gateway.py \
+        connect --ports 4000,4001,4002,4003 --rounds 50
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import os
+import random
+import socket
+import statistics
+import sys
+import threading
+import time
+from dataclasses import dataclass, field
+from typing import List, Optional
+from urllib.error import HTTPError, URLError
+from urllib.request import Request, urlopen
+
+IAC = 0xFF
+SB = 0xFA
+SE = 0xF0
+
+
+class TelnetFilter:
+    """Strip Telnet command sequences from a byte stream."""
+
+    def __init__(self) -> None:
+        self._state = "data"
+
+    def feed(self, data: bytes) -> bytes:
+        out = bytearray()
+        for b in data:
+            if self._state == "data":
+                if b == IAC:
+                    self._state = "iac"
+                else:
+                    out.append(b)
+            elif self._state == "iac":
+                if b == IAC:
+                    out.append(b)
+                    self._state = "data"
+                elif b == SB:
+                    self._state = "sb"
+                elif 0xFB <= b <= 0xFE:
+                    self._state = "opt"
+                else:
+                    self._state = "data"
+            elif self._state == "opt":
+                self._state = "data"
+            elif self._state == "sb":
+                if b == IAC:
+                    self._state = "sb_iac"
+            elif self._state == "sb_iac":
+                self._state = "data" if b == SE else "sb"
+        return bytes(out)
+
+
+@dataclass
+class PortResult:
+    tcp_port: int
+    sent: int = 0
+    received: int = 0
+    elapsed: float = 0.0
+    tx_rate: float = 0.0
+    rx_rate: float = 0.0
+    latencies: List[float] = field(default_factory=list)
+    error: Optional[str] = None
+
+    @property
+    def bytes_per_sec(self) -> float:
+        return self.received / self.elapsed if self.elapsed > 0 else 0.0
+
+
+def _payload(size: int, seed: int) -> bytes:
+    rng = random.Random(seed)
+    # 0xFF is excluded so the same payload works on telnet ports unescaped.
+    return bytes(rng.randrange(0, 0xFF) for _ in range(size))
+
+
+class RateMeter:
+    """Steady-state rate of a byte counter, ignoring its first quarter."""
+
+    def __init__(self, total: int) -> None:
+        self._mark = max(1, total // 4)
+        self._start: Optional[tuple] = None
+        self._last: Optional[tuple] = None
+
+    def update(self, count: int, now: float) -> None:
+        if self._start is None:
+            if count >= self._mark:
+                self._start = (count, now)
+        else:
+            self._last = (count, now)
+
+    @property
+    def rate(self) -> float:
+        if self._start is None or self._last is None or self._last[1] <= self._start[1]:
+            return 0.0
+        return (self._last[0] - self._start[0]) / (self._last[1] - self._start[1])
+
+
+def run_port(host: str, tcp_port: int, total: int, chunk: int, window: int,
+             timeout: float, telnet: bool) -> PortResult:
+    result = PortResult(tcp_port)
+    payload = _payload(total, tcp_port)
+    # Chunk i is complete once the receive count reaches chunk_ends[i].
+    chunk_ends = list(range(chunk, total, chunk)) + [total]
+    send_times: List[float] = [0.0] * len(chunk_ends)
+    cond = threading.Condition()
+    state = {"received": 0, "done": False}
+    tx_meter = RateMeter(total)
+    rx_meter = RateMeter(total)
+
+    try:
+        sock = socket.create_connection((host, tcp_port), timeout=timeout)
+    except OSError as exc:
+        result.error = f"connect failed: {exc}"
+        return result
+
+    sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    # Keep the host's send buffer small so send() returns at the pace the
+    # gateway takes data, not the pace the local kernel queues it.
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_SNDBUF, max(chunk, 4096))
+    sock.settimeout(timeout)
+    filt = TelnetFilter() if telnet else None
+
+    def receiver() -> None:
+        idx = 0
+        try:
+            while state["received"] < total:
+                data = sock.recv(4096)
+                if not data:
+                    raise ConnectionError("connection closed by gateway")
+                if filt:
+                    data = filt.feed(data)
+                now = time.perf_counter()
+                with cond:
+                    start = state["received"]
+                    if payload[start:start + len(data)] != data[:total - start]:
+                        raise ValueError(f"payload mismatch at offset {start}")
+                    state["received"] = start + len(data)
+                    rx_meter.update(state["received"], now)
+                    while idx < len(chunk_ends) and state["received"] >= chunk_ends[idx]:
+                        result.latencies.append(now - send_times[idx])
+                        idx += 1
+                    cond.notify_all()
+        except (OSError, ValueError, ConnectionError) as exc:
+            result.error = str(exc)
+        finally:
+            with cond:
+                state["done"] = True
+                cond.notify_all()
+
+    rx = threading.Thread(target=receiver, daemon=True)
+    rx.start()
+    begin = time.perf_counter()
+    offset = 0
+    try:
+        for i, end in enumerate(chunk_ends):
+            with cond:
+                while (window > 0 and not state["done"] and offset > state["received"]
+                       and end - state["received"] > window):
+                    if not cond.wait(timeout):
+                        raise TimeoutError("no progress within timeout")
+                if state["done"]:
+                    break
+            send_times[i] = time.perf_counter()
+            sock.sendall(payload[offset:end])
+            offset = end
+            result.sent = offset
+            tx_meter.update(offset, time.perf_counter())
+        rx.join(timeout + total / 1000.0)
+        if rx.is_alive():
+            raise TimeoutError("timed out waiting for loopback data")
+    except (OSError, TimeoutError) as exc:
+        result.error = result.error or str(exc)
+    finally:
+        result.elapsed = time.perf_counter() - begin
+        result.received = state["received"]
+        result.tx_rate = tx_meter.rate
+        result.rx_rate = rx_meter.rate
+        sock.close()
+    return result
+
+
+def _ms(value: float) -> str:
+    return f"{value * 1000.0:8.2f}"
+
+
+def _line_share(res: PortResult, baud: int) -> str:
+    if baud <= 0:
+        return ""
+    # 8N1 framing: ten bit times per byte on the wire.
+    line = baud / 10.0
+    return f" {100.0 * res.tx_rate / line:>6.1f} {100.0 * res.rx_rate / line:>6.1f}"
+
+
+def report(results: List[PortResult], baud: int = 0) -> int:
+    failures = 0
+    line_hdr = f" {'tx%':>6} {'rx%':>6}" if baud > 0 else ""
+    print(f"{'port':>6} {'bytes':>9} {'B/s':>10} {'tx B/s':>10} {'rx B/s':>10} "
+          f"{'p50 ms':>8} {'p99 ms':>8} {'max ms':>8}{line_hdr}")
+    for res in results:
+        if res.error:
+            failures += 1
+            print(f"{res.tcp_port:>6} {res.received:>9} error: {res.error}")
+            continue
+        lat = sorted(res.latencies) or [0.0]
+        p99 = lat[min(len(lat) - 1, int(len(lat) * 0.99))]
+        print(f"{res.tcp_port:>6} {res.received:>9} {res.bytes_per_sec:>10.0f} "
+              f"{res.tx_rate:>10.0f} {res.rx_rate:>10.0f} "
+              f"{_ms(statistics.median(lat))} {_ms(p99)} {_ms(lat[-1])}"
+              f"{_line_share(res, baud)}")
+    ok = [r for r in results if not r.error]
+    if len(ok) > 1:
+        total = sum(r.received for r in ok)
+        elapsed = max(r.elapsed for r in ok)
+        print(f"{'all':>6} {total:>9} {total / elapsed:>10.0f}")
+    return 1 if failures else 0
+
+
+def cmd_throughput(args: argparse.Namespace) -> int:
+    results: List[PortResult] = [PortResult(p) for p in args.ports]
+
+    def worker(i: int) -> None:
+        results[i] = run_port(args.host, args.ports[i], args.bytes, args.chunk,
+                              args.window, args.timeout, args.telnet)
+
+    threads = [threading.Thread(target=worker, args=(i,)) for i in range(len(args.ports))]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    return report(results, args.baud)
+
+
+def connect_latency(host: str, tcp_port: int, timeout: float) -> float:
+    """Time from connect() until the gateway's first Telnet negotiation byte.
+
+    lwIP completes the TCP handshake from the listen backlog, so the connect
+    itself says nothing about the runtime.  A telnet-mode session only starts
+    talking once listener_task accepted the socket and a session worker ran
+    its initialise hook, which makes the first byte a good accept marker.
+    """
+    begin = time.perf_counter()
+    with socket.create_connection((host, tcp_port), timeout=timeout) as sock:
+        sock.settimeout(timeout)
+        if not sock.recv(1):
+            raise ConnectionError("connection closed by gateway")
+        return time.perf_counter() - begin
+
+
+PROBE = b"U"
+
+
+def first_byte_latency(host: str, tcp_port: int, timeout: float) -> float:
+    """Time from connect() until a probe byte comes back through the UART.
+
+    The probe is written right after the handshake, so the figure covers the
+    accept, the UART bring-up for the session and one loopback round trip.
+    Works on raw and telnet ports (negotiation is filtered out).
+    """
+    filt = TelnetFilter()
+    begin = time.perf_counter()
+    with socket.create_connection((host, tcp_port), timeout=timeout) as sock:
+        sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        sock.settimeout(timeout)
+        sock.sendall(PROBE)
+        while True:
+            data = sock.recv(64)
+            if not data:
+                raise ConnectionError("connection closed by gateway")
+            if PROBE in filt.feed(data):
+                return time.perf_counter() - begin
+
+
+def cmd_connect(args: argparse.Namespace) -> int:
+    failures = 0
+    measure = first_byte_latency if args.first_byte else connect_latency
+    samples = {p: [] for p in args.ports}
+    for _ in range(args.rounds):
+        # Visit the ports in a different order every round so a listener
+        # that favours low indexes shows up as a skewed distribution.
+        order = list(args.ports)
+        random.shuffle(order)
+        for tcp_port in order:
+            try:
+                samples[tcp_port].append(measure(args.host, tcp_port, args.timeout))
+            except OSError as exc:
+                failures += 1
+                print(f"{tcp_port:>6} error: {exc}")
+            # Let the session worker tear down before the next connect.
+            time.sleep(args.gap)
+
+    print(f"{'port':>6} {'n':>4} {'p50 ms':>8} {'p99 ms':>8} {'max ms':>8}")
+    merged: List[float] = []
+    for tcp_port in args.ports:
+        lat = sorted(samples[tcp_port])
+        if not lat:
+            continue
+        merged.extend(lat)
+        p99 = lat[min(len(lat) - 1, int(len(lat) * 0.99))]
+        print(f"{tcp_port:>6} {len(lat):>4} {_ms(statistics.median(lat))} {_ms(p99)} {_ms(lat[-1])}")
+    if len(args.ports) > 1 and merged:
+        merged.sort()
+        p99 = merged[min(len(merged) - 1, int(len(merged) * 0.99))]
+        print(f"{'all':>6} {len(merged):>4} {_ms(statistics.median(merged))} {_ms(p99)} {_ms(merged[-1])}")
+    return 1 if failures else 0
+
+
+def _rewrite_port_mode(host: str, tcp_port: int, timeout: float,
+                       stop: threading.Event, counter: List[int]) -> None:
+    """Re-apply a port's current mode until stopped (a no-op mutation)."""
+    with urlopen(f"http://{host}/api/ports", timeout=timeout) as response:
+        ports = json.loads(response.read().decode("utf-8"))
+    port = next((p for p in ports if p["tcp_port"] == tcp_port), None)
+    if port is None:
+        raise SystemExit(f"port {tcp_port} not found on {host}")
+    body = json.dumps({"mode": port["mode"], "enabled": port["enabled"]}).encode()
+    while not stop.is_set():
+        request = Request(f"http://{host}/api/ports/{tcp_port}/mode", data=body,
+                          headers={"Content-Type": "application/json"})
+        try:
+            with urlopen(request, timeout=timeout) as response:
+                response.read()
+            counter[0] += 1
+        except HTTPError as exc:
+            if exc.code != 503:
+                raise
+            time.sleep(0.05)
+
+
+def cmd_http(args: argparse.Namespace) -> int:
+    failures = 0
+    writes = [0]
+    stop = threading.Event()
+    writer = None
+    if args.during_writes:
+        writer = threading.Thread(target=_rewrite_port_mode, daemon=True,
+                                  args=(args.host, args.during_writes, args.timeout, stop, writes))
+        writer.start()
+    print(f"{'path':<14} {'n':>4} {'304':>4} {'bytes':>7} {'p50 ms':>8} {'p99 ms':>8} {'max ms':>8}")
+    for path in args.paths:
+        lat: List[float] = []
+        size = 0
+        etag = None
+        not_modified = 0
+        for _ in range(args.rounds):
+            headers = {"If-None-Match": etag} if args.conditional and etag else {}
+            begin = time.perf_counter()
+            try:
+                with urlopen(Request(f"http://{args.host}{path}", headers=headers),
+                             timeout=args.timeout) as response:
+                    size = len(response.read())
+                    etag = response.headers.get("ETag")
+            except HTTPError as exc:
+                if exc.code != 304:
+                    failures += 1
+                    print(f"{path:<14} error: {exc}")
+                    continue
+                not_modified += 1
+            except (URLError, OSError) as exc:
+                failures += 1
+                print(f"{path:<14} error: {exc}")
+                continue
+            lat.append(time.perf_counter() - begin)
+        if not lat:
+            continue
+        lat.sort()
+        p99 = lat[min(len(lat) - 1, int(len(lat) * 0.99))]
+        print(f"{path:<14} {len(lat):>4} {not_modified:>4} {size:>7} {_ms(statistics.median(lat))} {_ms(p99)} {_ms(lat[-1])}")
+    if writer:
+        stop.set()
+        writer.join(args.timeout)
+        print(f"background writes completed: {writes[0]}")
+    return 1 if failures else 0
+
+
+def _port_list(value: str) -> List[int]:
+    return [int(p) for p in value.split(",") if p]
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--host", default=os.environ.get("SER2NET_ESP_IP"),
+                        help="gateway address (default: $SER2NET_ESP_IP)")
+    parser.add_argument("--timeout", type=float, default=5.0,
+                        help="socket/progress timeout in seconds")
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    tp = sub.add_parser("throughput", help="stream data through looped-back ports")
+    tp.add_argument("--ports", type=_port_list, default=[4000],
+                    help="comma separated TCP ports (default: 4000)")
+    tp.add_argument("--bytes", type=int, default=32768, help="payload size per port")
+    tp.add_argument("--chunk", type=int, default=256, help="bytes per send() call")
+    tp.add_argument("--window", type=int, default=2048,
+                    help="maximum bytes in flight per port (0: no limit)")
+    tp.add_argument("--telnet", action="store_true",
+                    help="strip Telnet negotiation from the receive stream")
+    tp.add_argument("--baud", type=int, default=0,
+                    help="UART baud rate; adds the TX and RX rates as a share of the line rate")
+    tp.set_defaults(func=cmd_throughput)
+
+    cp = sub.add_parser("connect", help="measure connect-to-accept latency")
+    cp.add_argument("--ports", type=_port_list, default=[4000],
+                    help="comma separated telnet-mode TCP ports (default: 4000)")
+    cp.add_argument("--rounds", type=int, default=20, help="connections per port")
+    cp.add_argument("--gap", type=float, default=0.2,
+                    help="pause between connections in seconds")
+    cp.add_argument("--first-byte", action="store_true",
+                    help="time until a probe byte is echoed back through a "
+                         "looped-back UART (connect-to-first-byte)")
+    cp.set_defaults(func=cmd_connect)
+
+    hp = sub.add_parser("http", help="measure REST API response latency")
+    hp.add_argument("--paths", type=lambda v: [p for p in v.split(",") if p],
+                    default=["/api/ports", "/api/system", "/api/wifi"],
+                    help="comma separated request paths")
+    hp.add_argument("--rounds", type=int, default=50, help="requests per path")
+    hp.add_argument("--conditional", action="store_true",
+                    help="send If-None-Match with the last ETag, like a browser")
+    hp.add_argument("--during-writes", type=int, default=0, metavar="TCP",
+                    help="keep re-applying this port's mode in the background")
+    hp.set_defaults(func=cmd_http)
+
+    args = parser.parse_args(argv)
+    if not args.host:
+        parser.error("no gateway address: pass --host or set SER2NET_ESP_IP")
+    return args.func(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -15,7 +15,7 @@ import os
 from typing import Any
 import json
 from urllib.error import URLError, HTTPError
-from urllib.request import urlopen
+from urllib.request import Request, urlopen
 
 import pytest
 
@@ -27,17 +27,19 @@ def _base_url() -> str:
     return f"http://{ip.strip()}"
 
 
-def _get_json(path: str) -> Any:
+def _get_text(path: str) -> str:
     url = f"{_base_url()}{path}"
     try:
         with urlopen(url, timeout=5) as response:
-            payload = response.read().decode("utf-8")
+            return response.read().decode("utf-8")
     except HTTPError as err:
         pytest.fail(f"HTTP error {err.code} for {url}: {err.reason}")
     except URLError as err:
         pytest.fail(f"Failed to reach {url}: {err.reason}")
 
-    return json.loads(payload)
+
+def _get_json(path: str) -> Any:
+    return json.loads(_get_text(path))
 
 
 def test_health_endpoint() -> None:
@@ -100,3 +102,108 @@ def test_wifi_status_endpoint() -> None:
     }
     for key in expected_keys:
         assert key in payload
+
+
+def test_metrics_endpoint() -> None:
+    payload = _get_text("/api/metrics")
+    samples = {}
+    for line in payload.splitlines():
+        if not line or line.startswith("#"):
+            continue
+        name, value = line.rsplit(" ", 1)
+        samples[name] = float(value)
+
+    for key in ("ser2net_uptime_seconds", "ser2net_free_heap_bytes",
+                "ser2net_min_free_heap_bytes", "ser2net_configured_ports",
+                "ser2net_active_sessions"):
+        assert key in samples
+
+    port_samples = [n for n in samples if n.startswith("ser2net_port_enabled{")]
+    assert len(port_samples) == samples["ser2net_configured_ports"]
+
+
+def test_static_assets_revalidate() -> None:
+    url = f"{_base_url()}/static/app.js"
+    with urlopen(Request(url, headers={"Accept-Encoding": "gzip"}), timeout=5) as response:
+        assert response.headers.get("Content-Encoding") == "gzip"
+        etag = response.headers.get("ETag")
+        body = response.read()
+    assert etag and body[:2] == b"\x1f\x8b"
+
+    with pytest.raises(HTTPError) as excinfo:
+        urlopen(Request(url, headers={"If-None-Match": etag}), timeout=5)
+    assert excinfo.value.code == 304
+
+
+def test_ports_conditional_get() -> None:
+    url = f"{_base_url()}/api/ports"
+    with urlopen(url, timeout=5) as response:
+        etag = response.headers.get("ETag")
+    assert etag
+
+    try:
+        urlopen(Request(url, headers={"If-None-Match": etag}), timeout=5).close()
+    except HTTPError as err:
+        assert err.code == 304
+    else:
+        pytest.skip("port listing changed between requests")
+
+
+def test_event_stream_initial_state() -> None:
+    url = f"{_base_url()}/api/events"
+    try:
+        response = urlopen(url, timeout=5)
+    except HTTPError as err:
+        if err.code == 503:
+            pytest.skip("all event stream slots are in use")
+        raise
+
+    events = {}
+    name = None
+    with response:
+        assert response.headers.get_content_type() == "text/event-stream"
+        while len(events) < 3:
+            line = response.readline().decode("utf-8").rstrip("\n")
+            if line.startswith("event: "):
+                name = line[len("event: "):]
+            elif line.startswith("data: ") and name:
+                events[name] = json.loads(line[len("data: "):])
+
+    assert isinstance(events["ports"], list)
+    assert "uptime_ms" in events["system"]
+    assert "sta_connected" in events["wifi"]
+
+
+def test_ports_batch_rejects_invalid_batch() -> None:
+    # An invalid item makes the whole batch a no-op, so this is safe to run
+    # against a live device.
+    body = json.dumps([{"op": "delete", "tcp_port": 1}, {"op": "frob"}]).encode()
+    request = Request(f"{_base_url()}/api/ports", data=body, method="PATCH",
+                      headers={"Content-Type": "application/json"})
+    with pytest.raises(HTTPError) as excinfo:
+        urlopen(request, timeout=5)
+    if excinfo.value.code == 403:
+        pytest.skip("dynamic sessions disabled")
+    assert excinfo.value.code == 400
+
+    payload = json.loads(excinfo.value.read().decode("utf-8"))
+    assert payload["applied"] == 0
+    assert [r["status"] for r in payload["results"]] == ["error", "error"]
+
+
+def test_ports_batch_long_rejection_keeps_status() -> None:
+    # Enough error items to push the results past the first 512-byte chunk,
+    # which must still carry the 400 status and JSON content type.
+    ops = [{"op": "mode", "tcp_port": 1, "mode": "raw"} for _ in range(16)]
+    request = Request(f"{_base_url()}/api/ports", data=json.dumps(ops).encode(),
+                      method="PATCH", headers={"Content-Type": "application/json"})
+    with pytest.raises(HTTPError) as excinfo:
+        urlopen(request, timeout=5)
+    if excinfo.value.code == 403:
+        pytest.skip("dynamic sessions disabled")
+    assert excinfo.value.code == 400
+    assert excinfo.value.headers["Content-Type"].startswith("application/json")
+
+    payload = json.loads(excinfo.value.read().decode("utf-8"))
+    assert payload["applied"] == 0
+    assert [r["status"] for r in payload["results"]] == ["error"] * 16